@@ -83,7 +83,7 @@ void CircletoPolygon(KManifold& m, std::shared_ptr<KShape> a, std::shared_ptr<KS
 	// Exact concept as using support points in Polygon vs Polygon
 	float separation = -FLT_MAX;
 	unsigned int faceNormal = 0;
-	for (uint32 i = 0; i < B->m_vertices.size(); ++i)
+	for (uint32 i = 0; i < B->m_vertexCount; ++i)
 	{
 		float s = KVector2::Dot(B->m_normals[i], center - B->m_vertices[i]);
 
@@ -99,7 +99,7 @@ void CircletoPolygon(KManifold& m, std::shared_ptr<KShape> a, std::shared_ptr<KS
 
 	// Grab face's vertices
 	KVector2 v1 = B->m_vertices[faceNormal];
-	uint32 i2 = faceNormal + 1 < B->m_vertices.size() ? faceNormal + 1 : 0;
+	uint32 i2 = faceNormal + 1 < B->m_vertexCount ? faceNormal + 1 : 0;
 	KVector2 v2 = B->m_vertices[i2];
 
 	// Check to see if center is within polygon
@@ -172,7 +172,7 @@ float FindAxisLeastPenetration(uint32 *faceIndex, std::shared_ptr<KPolygonShape>
 	float bestDistance = -FLT_MAX;
 	uint32 bestIndex = 0;
 
-	for (uint32 i = 0; i < A->m_vertices.size(); ++i)
+	for (uint32 i = 0; i < A->m_vertexCount; ++i)
 	{
 		// Retrieve a face normal from A
 		KVector2 n = A->m_normals[i];
@@ -188,8 +188,8 @@ float FindAxisLeastPenetration(uint32 *faceIndex, std::shared_ptr<KPolygonShape>
 		// Retrieve vertex on face from A, transform into
 		// B's model space
 		KVector2 v = A->m_vertices[i];
-		v = A->rotation * v + A->body->position;
-		v -= B->body->position;
+		v = A->rotation * v + A->body->GetPosition();
+		v -= B->body->GetPosition();
 		v = buT * v;
 
 		// Compute penetration distance (in B's model space)
@@ -218,7 +218,7 @@ void FindIncidentFace(KVector2 *v, std::shared_ptr<KPolygonShape> RefPoly, std::
 	// Find most anti-normal face on incident polygon
 	int32 incidentFace = 0;
 	float minDot = FLT_MAX;
-	for (uint32 i = 0; i < IncPoly->m_vertices.size(); ++i)
+	for (uint32 i = 0; i < IncPoly->m_vertexCount; ++i)
 	{
 		float dot = KVector2::Dot(referenceNormal, IncPoly->m_normals[i]);
 		if (dot < minDot)
@@ -229,9 +229,9 @@ void FindIncidentFace(KVector2 *v, std::shared_ptr<KPolygonShape> RefPoly, std::
 	}
 
 	// Assign face vertices for incidentFace
-	v[0] = IncPoly->rotation * IncPoly->m_vertices[incidentFace] + IncPoly->body->position;
-	incidentFace = incidentFace + 1 >= (int32)IncPoly->m_vertices.size() ? 0 : incidentFace + 1;
-	v[1] = IncPoly->rotation * IncPoly->m_vertices[incidentFace] + IncPoly->body->position;
+	v[0] = IncPoly->rotation * IncPoly->m_vertices[incidentFace] + IncPoly->body->GetPosition();
+	incidentFace = incidentFace + 1 >= (int32)IncPoly->m_vertexCount ? 0 : incidentFace + 1;
+	v[1] = IncPoly->rotation * IncPoly->m_vertices[incidentFace] + IncPoly->body->GetPosition();
 }
 
 int32 Clip(KVector2 n, float c, KVector2 *face)
@@ -335,12 +335,12 @@ void PolygontoPolygon(KManifold& m, std::shared_ptr<KShape> a, std::shared_ptr<K
 
 	// Setup reference face vertices
 	KVector2 v1 = RefPoly->m_vertices[referenceIndex];
-	referenceIndex = referenceIndex + 1 == RefPoly->m_vertices.size() ? 0 : referenceIndex + 1;
+	referenceIndex = referenceIndex + 1 == RefPoly->m_vertexCount ? 0 : referenceIndex + 1;
 	KVector2 v2 = RefPoly->m_vertices[referenceIndex];
 
 	// Transform vertices to world space
-	v1 = RefPoly->rotation * v1 + RefPoly->body->position;
-	v2 = RefPoly->rotation * v2 + RefPoly->body->position;
+	v1 = RefPoly->rotation * v1 + RefPoly->body->GetPosition();
+	v2 = RefPoly->rotation * v2 + RefPoly->body->GetPosition();
 
 	// Calculate reference face side normal in world space
 	KVector2 sidePlaneNormal = (v2 - v1);
@@ -371,6 +371,7 @@ void PolygontoPolygon(KManifold& m, std::shared_ptr<KShape> a, std::shared_ptr<K
 	if (separation <= 0.0f)
 	{
 		m.contacts[cp] = incidentFace[0];
+		m.depths[cp] = -separation;
 		m.penetration = -separation;
 		++cp;
 	}
@@ -381,6 +382,7 @@ void PolygontoPolygon(KManifold& m, std::shared_ptr<KShape> a, std::shared_ptr<K
 	if (separation <= 0.0f)
 	{
 		m.contacts[cp] = incidentFace[1];
+		m.depths[cp] = -separation;
 
 		m.penetration += -separation;
 		++cp;
@@ -0,0 +1,211 @@
+#include "KBodyStore.h"
+#include <cmath>
+
+KBodyHandle KBodyStore::Create(KRigidbody* owner_, const KBodyState& state)
+{
+	uint32 slot;
+	if (m_freeSlots.empty())
+	{
+		slot = (uint32)m_slots.size();
+		m_slots.push_back(Slot{ k_free, 0 });
+	}
+	else
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+
+	const uint32 i = GetCount();
+	m_slots[slot].dense = i;
+	m_denseSlot.push_back(slot);
+
+	position.push_back(state.position);
+	velocity.push_back(state.velocity);
+	rotation.push_back(state.rotation);
+	angularVelocity.push_back(state.angularVelocity);
+	force.push_back(state.force);
+	torque.push_back(state.torque);
+	mass.push_back(state.mass);
+	invMass.push_back(state.invMass);
+	inertia.push_back(state.inertia);
+	invInertia.push_back(state.invInertia);
+	linearDamping.push_back(0.0f);
+	angularDamping.push_back(0.0f);
+	linearDecay.push_back(1.0f);
+	angularDecay.push_back(1.0f);
+	subStepLinearDecay.push_back(1.0f);
+	subStepAngularDecay.push_back(1.0f);
+	material.push_back(state.material);
+	owner.push_back(owner_);
+	SetDamping(i, state.linearDamping, state.angularDamping);
+
+	KBodyHandle handle;
+	handle.index = slot;
+	handle.generation = m_slots[slot].generation;
+	return handle;
+}
+
+void KBodyStore::GetState(uint32 i, KBodyState& state) const
+{
+	state.position = position[i];
+	state.velocity = velocity[i];
+	state.rotation = rotation[i];
+	state.angularVelocity = angularVelocity[i];
+	state.force = force[i];
+	state.torque = torque[i];
+	state.mass = mass[i];
+	state.invMass = invMass[i];
+	state.inertia = inertia[i];
+	state.invInertia = invInertia[i];
+	state.linearDamping = linearDamping[i];
+	state.angularDamping = angularDamping[i];
+	state.material = material[i];
+}
+
+void KBodyStore::Destroy(KBodyHandle handle)
+{
+	assert(IsValid(handle));
+	if (!IsValid(handle))
+		return;
+
+	// Swap the last body into the hole
+	const uint32 i = m_slots[handle.index].dense;
+	const uint32 last = GetCount() - 1;
+	if (i != last)
+	{
+		position[i] = position[last];
+		velocity[i] = velocity[last];
+		rotation[i] = rotation[last];
+		angularVelocity[i] = angularVelocity[last];
+		force[i] = force[last];
+		torque[i] = torque[last];
+		mass[i] = mass[last];
+		invMass[i] = invMass[last];
+		inertia[i] = inertia[last];
+		invInertia[i] = invInertia[last];
+		linearDamping[i] = linearDamping[last];
+		angularDamping[i] = angularDamping[last];
+		linearDecay[i] = linearDecay[last];
+		angularDecay[i] = angularDecay[last];
+		subStepLinearDecay[i] = subStepLinearDecay[last];
+		subStepAngularDecay[i] = subStepAngularDecay[last];
+		material[i] = material[last];
+		owner[i] = owner[last];
+		m_denseSlot[i] = m_denseSlot[last];
+		m_slots[m_denseSlot[i]].dense = i;
+	}
+
+	position.pop_back();
+	velocity.pop_back();
+	rotation.pop_back();
+	angularVelocity.pop_back();
+	force.pop_back();
+	torque.pop_back();
+	mass.pop_back();
+	invMass.pop_back();
+	inertia.pop_back();
+	invInertia.pop_back();
+	linearDamping.pop_back();
+	angularDamping.pop_back();
+	linearDecay.pop_back();
+	angularDecay.pop_back();
+	subStepLinearDecay.pop_back();
+	subStepAngularDecay.pop_back();
+	material.pop_back();
+	owner.pop_back();
+	m_denseSlot.pop_back();
+
+	m_slots[handle.index].dense = k_free;
+	m_slots[handle.index].generation++;
+	m_freeSlots.push_back(handle.index);
+}
+
+void KBodyStore::Clear()
+{
+	for (uint32 i = 0; i < GetCount(); ++i)
+	{
+		Slot& slot = m_slots[m_denseSlot[i]];
+		slot.dense = k_free;
+		slot.generation++;
+		m_freeSlots.push_back(m_denseSlot[i]);
+	}
+
+	position.clear();
+	velocity.clear();
+	rotation.clear();
+	angularVelocity.clear();
+	force.clear();
+	torque.clear();
+	mass.clear();
+	invMass.clear();
+	inertia.clear();
+	invInertia.clear();
+	linearDamping.clear();
+	angularDamping.clear();
+	linearDecay.clear();
+	angularDecay.clear();
+	subStepLinearDecay.clear();
+	subStepAngularDecay.clear();
+	material.clear();
+	owner.clear();
+	m_denseSlot.clear();
+}
+
+void KBodyStore::SetDamping(uint32 i, float linear, float angular)
+{
+	linearDamping[i] = linear;
+	angularDamping[i] = angular;
+	linearDecay[i] = std::exp(-linear * m_decayDt);
+	angularDecay[i] = std::exp(-angular * m_decayDt);
+	subStepLinearDecay[i] = std::exp(-linear * m_subStepDecayDt);
+	subStepAngularDecay[i] = std::exp(-angular * m_subStepDecayDt);
+}
+
+void KBodyStore::SetDecayDt(float dt)
+{
+	if (dt == m_decayDt)
+		return;
+
+	m_decayDt = dt;
+	for (uint32 i = 0; i < GetCount(); ++i)
+	{
+		linearDecay[i] = std::exp(-linearDamping[i] * dt);
+		angularDecay[i] = std::exp(-angularDamping[i] * dt);
+	}
+}
+
+void KBodyStore::SetSubStepDecayDt(float h)
+{
+	if (h == m_subStepDecayDt)
+		return;
+
+	m_subStepDecayDt = h;
+	for (uint32 i = 0; i < GetCount(); ++i)
+	{
+		subStepLinearDecay[i] = std::exp(-linearDamping[i] * h);
+		subStepAngularDecay[i] = std::exp(-angularDamping[i] * h);
+	}
+}
+
+void KBodyStore::Reserve(uint32 count)
+{
+	position.reserve(count);
+	velocity.reserve(count);
+	rotation.reserve(count);
+	angularVelocity.reserve(count);
+	force.reserve(count);
+	torque.reserve(count);
+	mass.reserve(count);
+	invMass.reserve(count);
+	inertia.reserve(count);
+	invInertia.reserve(count);
+	linearDamping.reserve(count);
+	angularDamping.reserve(count);
+	linearDecay.reserve(count);
+	angularDecay.reserve(count);
+	subStepLinearDecay.reserve(count);
+	subStepAngularDecay.reserve(count);
+	material.reserve(count);
+	owner.reserve(count);
+	m_denseSlot.reserve(count);
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <cassert>
+#include <vector>
+#include "KMath.h"
+#include "KMaterial.h"
+
+struct KRigidbody;
+
+// Names a body of a KBodyStore. A handle goes stale when its body is
+// destroyed, even if the slot is reused by a later body.
+struct KBodyHandle
+{
+	uint32 index = 0xffffffff;	// slot
+	uint32 generation = 0;
+
+	bool operator==(const KBodyHandle& rhs) const { return index == rhs.index && generation == rhs.generation; }
+	bool operator!=(const KBodyHandle& rhs) const { return !(*this == rhs); }
+};
+
+// State of one body outside a store, e.g. before it is added to the world
+struct KBodyState
+{
+	KVector2	position;
+	KVector2	velocity;
+	float		rotation = 0.0f;			// radians
+	float		angularVelocity = 0.0f;
+	KVector2	force;
+	float		torque = 0.0f;
+	float		mass = 0.0f;
+	float		invMass = 0.0f;
+	float		inertia = 0.0f;				// moment of inertia
+	float		invInertia = 0.0f;
+	float		linearDamping = 0.0f;
+	float		angularDamping = 0.0f;
+	KMaterialId	material = KMaterialTable::k_default;
+};
+
+// Rigidbody state as structure-of-arrays. The live bodies are kept dense in
+// [0, GetCount()) so integration and the contact solver stream over the
+// arrays; a handle finds its dense index through the slot table.
+// Destroy() moves the last body into the hole, so dense indices are only
+// stable until the next Destroy().
+class KBodyStore
+{
+public:
+	KBodyHandle Create(KRigidbody* owner, const KBodyState& state);
+	void Destroy(KBodyHandle handle);
+	// Invalidates all handles
+	void Clear();
+	void Reserve(uint32 count);
+
+	bool IsValid(KBodyHandle handle) const
+	{
+		return handle.index < (uint32)m_slots.size() && m_slots[handle.index].generation == handle.generation
+			&& m_slots[handle.index].dense != k_free;
+	}
+	uint32 GetIndex(KBodyHandle handle) const { assert(IsValid(handle)); return m_slots[handle.index].dense; }
+	uint32 GetCount() const { return (uint32)owner.size(); }
+
+	// Copies body i out, e.g. before destroying it
+	void GetState(uint32 i, KBodyState& state) const;
+	// Sets the damping of body i and its cached decay factors
+	void SetDamping(uint32 i, float linear, float angular);
+	// Recomputes the decay factors when the step length changes
+	void SetDecayDt(float dt);
+	// Same for the sub-step decay factors of the soft solver, h = dt / subSteps
+	void SetSubStepDecayDt(float h);
+
+	// dense arrays, indexed by GetIndex()
+	std::vector<KVector2>		position;
+	std::vector<KVector2>		velocity;
+	std::vector<float>			rotation;			// radians
+	std::vector<float>			angularVelocity;
+	std::vector<KVector2>		force;
+	std::vector<float>			torque;
+	std::vector<float>			mass;
+	std::vector<float>			invMass;
+	std::vector<float>			inertia;			// moment of inertia
+	std::vector<float>			invInertia;
+	std::vector<float>			linearDamping;		// set through SetDamping()
+	std::vector<float>			angularDamping;
+	std::vector<float>			linearDecay;		// exp(-linearDamping * dt), velocity scale per step
+	std::vector<float>			angularDecay;
+	std::vector<float>			subStepLinearDecay;	// exp(-linearDamping * h), velocity scale per soft sub-step
+	std::vector<float>			subStepAngularDecay;
+	std::vector<KMaterialId>	material;
+	std::vector<KRigidbody*>	owner;				// facade of each body
+
+private:
+	static const uint32 k_free = 0xffffffff;
+
+	struct Slot
+	{
+		uint32 dense;		// k_free when unused
+		uint32 generation;
+	};
+	std::vector<Slot>			m_slots;
+	std::vector<uint32>			m_denseSlot;		// slot of each dense entry
+	std::vector<uint32>			m_freeSlots;
+	float						m_decayDt = 0.0f;	// step length of the decay factors
+	float						m_subStepDecayDt = 0.0f;
+};
@@ -13,10 +13,8 @@ void KCircleShape::Initialize()
 
 void KCircleShape::ComputeMass(float density)
 {
-	body->m_mass = PI * radius * radius * density;
-	body->m_invMass = (body->m_mass) ? 1.0f / body->m_mass : 0.0f;
-	body->m_I = body->m_mass * radius * radius;
-	body->m_invI = (body->m_I) ? 1.0f / body->m_I : 0.0f;
+	const float mass = PI * radius * radius * density;
+	body->SetMassData(mass, mass * radius * radius);
 }
 
 void KCircleShape::SetRotation(float radians)
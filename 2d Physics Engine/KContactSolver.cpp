@@ -0,0 +1,622 @@
+#include "KContactSolver.h"
+#include "KPhysicsEngine.h"
+#include "KThreadPool.h"
+
+void KContactConstraints::Resize(uint32 numManifolds)
+{
+	m_count = numManifolds;
+
+	indexA.resize(numManifolds);
+	indexB.resize(numManifolds);
+	pointCount.resize(numManifolds);
+	normal.resize(numManifolds);
+	tangent.resize(numManifolds);
+	staticFriction.resize(numManifolds);
+	dynamicFriction.resize(numManifolds);
+	blockSolve.resize(numManifolds);
+	blockK.resize(numManifolds);
+	blockNormalMass.resize(numManifolds);
+
+	const uint32 numPoints = numManifolds * 2;
+	ra.resize(numPoints);
+	rb.resize(numPoints);
+	normalMass.resize(numPoints);
+	tangentMass.resize(numPoints);
+	bias.resize(numPoints);
+	normalImpulse.resize(numPoints);
+	tangentImpulse.resize(numPoints);
+	localAnchorA.resize(numPoints);
+	localAnchorB.resize(numPoints);
+	separation.resize(numPoints);
+	maxNormalImpulse.resize(numPoints);
+}
+
+void KContactSolver::Initialize(const KBodyStore& bodies, const std::vector<KManifold>& contacts,
+	const KMaterialTable& materials, float dt)
+{
+	// Gather the velocity state into compact arrays
+	m_velocity.assign(bodies.velocity.begin(), bodies.velocity.end());
+	m_angularVelocity.assign(bodies.angularVelocity.begin(), bodies.angularVelocity.end());
+	m_invMass.assign(bodies.invMass.begin(), bodies.invMass.end());
+	m_invI.assign(bodies.invInertia.begin(), bodies.invInertia.end());
+	m_velocity.push_back(KVector2::zero);
+	m_angularVelocity.push_back(0.0f);
+	m_invMass.push_back(0.0f);
+	m_invI.push_back(0.0f);
+
+	_Colorize(contacts);
+
+	// If the only thing moving an object is gravity, the collision is
+	// resolved without any restitution
+	const float restingSpeedSq = (dt * KWorld::gravity).LengthSquared() + EPSILON;
+
+	KContactConstraints& c = m_constraints;
+	c.Resize((uint32)contacts.size());
+	for (uint32 k = 0; k < c.m_count; ++k)
+	{
+		const KManifold& m = contacts[k];
+		const uint32 i = m_manifoldSlot[k];
+		const uint32 iA = m.rigidbodyA->GetIndex();
+		const uint32 iB = m.rigidbodyB->GetIndex();
+
+		c.indexA[i] = iA;
+		c.indexB[i] = iB;
+		c.pointCount[i] = m.contact_count;
+		c.normal[i] = m.normal;
+		c.tangent[i] = KVector2::Cross(m.normal, 1.0f);
+		const KMaterialPair& mix = materials.GetPair(bodies.material[iA], bodies.material[iB]);
+		c.staticFriction[i] = mix.staticFriction;
+		c.dynamicFriction[i] = mix.dynamicFriction;
+
+		float restitution = mix.restitution;
+		const float mA = m_invMass[iA], mB = m_invMass[iB];
+		const float invIA = m_invI[iA], invIB = m_invI[iB];
+		const KMatrix2 invRotA = KMatrix2(bodies.rotation[iA]).Transpose();
+		const KMatrix2 invRotB = KMatrix2(bodies.rotation[iB]).Transpose();
+
+		for (uint32 j = 0; j < m.contact_count; ++j)
+		{
+			const uint32 p = 2 * i + j;
+			const KVector2 ra = m.contacts[j] - bodies.position[iA];
+			const KVector2 rb = m.contacts[j] - bodies.position[iB];
+			c.ra[p] = ra;
+			c.rb[p] = rb;
+			c.localAnchorA[p] = invRotA * ra;
+			c.localAnchorB[p] = invRotB * rb;
+			c.separation[p] = -m.depths[j];
+
+			const float rnA = KVector2::Cross(ra, m.normal);
+			const float rnB = KVector2::Cross(rb, m.normal);
+			const float kNormal = mA + mB + invIA * rnA * rnA + invIB * rnB * rnB;
+			c.normalMass[p] = kNormal > 0.0f ? 1.0f / kNormal : 0.0f;
+
+			const float rtA = KVector2::Cross(ra, c.tangent[i]);
+			const float rtB = KVector2::Cross(rb, c.tangent[i]);
+			const float kTangent = mA + mB + invIA * rtA * rtA + invIB * rtB * rtB;
+			c.tangentMass[p] = kTangent > 0.0f ? 1.0f / kTangent : 0.0f;
+
+			c.normalImpulse[p] = 0.0f;
+			c.tangentImpulse[p] = 0.0f;
+			c.maxNormalImpulse[p] = 0.0f;
+
+			const KVector2 rv = m_velocity[iB] + KVector2::Cross(m_angularVelocity[iB], rb)
+				- m_velocity[iA] - KVector2::Cross(m_angularVelocity[iA], ra);
+			if (rv.LengthSquared() < restingSpeedSq)
+				restitution = 0.0f;
+			c.bias[p] = KVector2::Dot(rv, m.normal);
+		}
+
+		// Restitution is mixed per manifold, so the bias is finalized once all
+		// points had a chance to flag a resting contact
+		for (uint32 j = 0; j < m.contact_count; ++j)
+		{
+			const uint32 p = 2 * i + j;
+			const float vn = c.bias[p];
+			c.bias[p] = vn < 0.0f ? -restitution * vn : 0.0f;
+		}
+
+		// Two points on a face are coupled through the bodies' rotation, solving
+		// them one after the other makes the body rock. Solve them together unless
+		// the pair is nearly redundant, then K is too ill-conditioned to invert.
+		c.blockSolve[i] = 0;
+		if (m.contact_count == 2)
+		{
+			const uint32 p = 2 * i;
+			const float rn1A = KVector2::Cross(c.ra[p], m.normal);
+			const float rn1B = KVector2::Cross(c.rb[p], m.normal);
+			const float rn2A = KVector2::Cross(c.ra[p + 1], m.normal);
+			const float rn2B = KVector2::Cross(c.rb[p + 1], m.normal);
+			const float k11 = mA + mB + invIA * rn1A * rn1A + invIB * rn1B * rn1B;
+			const float k22 = mA + mB + invIA * rn2A * rn2A + invIB * rn2B * rn2B;
+			const float k12 = mA + mB + invIA * rn1A * rn2A + invIB * rn1B * rn2B;
+			if (k11 * k11 < m_maxBlockCondition * (k11 * k22 - k12 * k12))
+			{
+				c.blockSolve[i] = 1;
+				c.blockK[i].Set(k11, k12, k12, k22);
+				c.blockNormalMass[i] = c.blockK[i].GetInverse();
+			}
+		}
+	}
+}
+
+void KContactSolver::_Colorize(const std::vector<KManifold>& contacts)
+{
+	const uint32 numManifolds = (uint32)contacts.size();
+	m_bodyColors.assign(m_invMass.size(), 0);
+	m_manifoldColor.resize(numManifolds);
+	m_manifoldSlot.resize(numManifolds);
+	m_colorOffsets.assign(k_maxColors + 2, 0);
+	m_nextPairColors.clear();
+
+	for (uint32 i = 0; i < numManifolds; ++i)
+	{
+		const KManifold& m = contacts[i];
+		const uint32 iA = m.rigidbodyA->GetIndex();
+		const uint32 iB = m.rigidbodyB->GetIndex();
+		const bool dynamicA = m_invMass[iA] != 0.0f;
+		const bool dynamicB = m_invMass[iB] != 0.0f;
+		const uint32 used = (dynamicA ? m_bodyColors[iA] : 0) | (dynamicB ? m_bodyColors[iB] : 0);
+
+		// Keep the colour this pair had last step if it is still free, so the
+		// colouring (and the solve order) stays stable while the pair set barely changes
+		std::pair<const KRigidbody*, const KRigidbody*> key(m.rigidbodyA.get(), m.rigidbodyB.get());
+		if (key.second < key.first)
+			std::swap(key.first, key.second);
+
+		uint32 color = k_maxColors;
+		auto hint = m_pairColors.find(key);
+		if (hint != m_pairColors.end() && hint->second < k_maxColors && (used & (1u << hint->second)) == 0)
+		{
+			color = hint->second;
+		}
+		else
+		{
+			for (uint32 c = 0; c < k_maxColors; ++c)
+			{
+				if ((used & (1u << c)) == 0)
+				{
+					color = c;
+					break;
+				}
+			}
+		}
+
+		if (color < k_maxColors)
+		{
+			if (dynamicA) m_bodyColors[iA] |= 1u << color;
+			if (dynamicB) m_bodyColors[iB] |= 1u << color;
+		}
+		m_manifoldColor[i] = color;
+		m_colorOffsets[color + 1] += 1;
+		m_nextPairColors[key] = color;
+	}
+	m_pairColors.swap(m_nextPairColors);
+
+	// Prefix sum into ranges, then hand out the slots colour by colour
+	for (uint32 c = 0; c <= k_maxColors; ++c)
+		m_colorOffsets[c + 1] += m_colorOffsets[c];
+	uint32 cursor[k_maxColors + 1];
+	std::copy(m_colorOffsets.begin(), m_colorOffsets.end() - 1, cursor);
+	for (uint32 i = 0; i < numManifolds; ++i)
+		m_manifoldSlot[i] = cursor[m_manifoldColor[i]]++;
+}
+
+void KContactSolver::Solve(uint32 minIterations, uint32 maxIterations)
+{
+	m_stats.numConstraints = m_constraints.m_count;
+	m_stats.velocityIterations = 0;
+	m_stats.impulseDelta = 0.0f;
+
+	m_isWide = m_useSimd;
+	if (m_isWide)
+		_PrepareWide();
+
+	const uint32 numThreads = m_threadPool ? m_threadPool->GetThreadCount() : 1;
+	if (numThreads <= 1 || m_constraints.m_count < m_minParallelConstraints)
+	{
+		for (uint32 j = 0; j < maxIterations; ++j)
+		{
+			m_stats.impulseDelta = _SolveIteration(0, 1, nullptr);
+			m_stats.velocityIterations = j + 1;
+			if (j + 1 >= minIterations && m_stats.impulseDelta <= m_impulseTolerance)
+				break;
+		}
+		return;
+	}
+
+	m_threadValue.resize(numThreads);
+	KSpinBarrier barrier(numThreads);
+	m_threadPool->Dispatch(numThreads, [&](uint32 threadIndex)
+	{
+		for (uint32 j = 0; j < maxIterations; ++j)
+		{
+			const float delta = _ReduceMax(threadIndex, numThreads, _SolveIteration(threadIndex, numThreads, &barrier), barrier);
+			if (threadIndex == 0)
+			{
+				m_stats.impulseDelta = delta;
+				m_stats.velocityIterations = j + 1;
+			}
+			if (j + 1 >= minIterations && delta <= m_impulseTolerance)
+				break;
+		}
+	});
+}
+
+float KContactSolver::_ReduceMax(uint32 threadIndex, uint32 numThreads, float value, KSpinBarrier& barrier)
+{
+	m_threadValue[threadIndex] = value;
+	barrier.Wait();
+	float result = 0.0f;
+	for (uint32 t = 0; t < numThreads; ++t)
+		result = __max(result, m_threadValue[t]);
+	// Nobody may write the next value before all threads read this one
+	barrier.Wait();
+	return result;
+}
+
+void KContactSolver::_GetThreadRange(uint32 threadIndex, uint32 numThreads, uint32 minPerThread, uint32& begin, uint32& end)
+{
+	const uint32 count = end - begin;
+	if (count >= numThreads * minPerThread)
+	{
+		const uint32 chunk = (count + numThreads - 1) / numThreads;
+		end = begin + __min((threadIndex + 1) * chunk, count);
+		begin = begin + __min(threadIndex * chunk, count);
+	}
+	else if (threadIndex != 0)
+	{
+		begin = end;
+	}
+}
+
+float KContactSolver::_SolveIteration(uint32 threadIndex, uint32 numThreads, KSpinBarrier* barrier)
+{
+	float delta = 0.0f;
+	const std::vector<uint32>& offsets = m_isWide ? m_wideColorOffsets : m_colorOffsets;
+	// Small colours are not worth splitting
+	const uint32 minPerThread = m_isWide ? 2 : 8;
+
+	for (uint32 c = 0; c < k_maxColors; ++c)
+	{
+		uint32 b = offsets[c];
+		uint32 e = offsets[c + 1];
+		if (b == e)
+			continue;
+
+		_GetThreadRange(threadIndex, numThreads, minPerThread, b, e);
+		const float rangeDelta = m_isWide ? _SolveWideRange(b, e) : _SolveRange(b, e);
+		delta = __max(delta, rangeDelta);
+
+		if (barrier)
+			barrier->Wait();
+	}
+
+	const uint32 overflowBegin = m_colorOffsets[k_maxColors];
+	const uint32 overflowEnd = m_colorOffsets[k_maxColors + 1];
+	if (overflowBegin != overflowEnd)
+	{
+		if (threadIndex == 0)
+		{
+			const float rangeDelta = _SolveRange(overflowBegin, overflowEnd);
+			delta = __max(delta, rangeDelta);
+		}
+		if (barrier)
+			barrier->Wait();
+	}
+	return delta;
+}
+
+float KContactSolver::_SolveRange(uint32 begin, uint32 end)
+{
+	float delta = 0.0f;
+	for (uint32 i = begin; i < end; ++i)
+	{
+		const float manifoldDelta = _SolveManifold(i);
+		delta = __max(delta, manifoldDelta);
+	}
+	return delta;
+}
+
+float KContactSolver::_SolveManifold(uint32 i)
+{
+	float delta = 0.0f;
+	KContactConstraints& c = m_constraints;
+	const uint32 iA = c.indexA[i];
+	const uint32 iB = c.indexB[i];
+	const float mA = m_invMass[iA], mB = m_invMass[iB];
+	const float invIA = m_invI[iA], invIB = m_invI[iB];
+	const KVector2 n = c.normal[i];
+	const KVector2 t = c.tangent[i];
+
+	KVector2 vA = m_velocity[iA];
+	KVector2 vB = m_velocity[iB];
+	float wA = m_angularVelocity[iA];
+	float wB = m_angularVelocity[iB];
+
+	if (c.blockSolve[i])
+	{
+		// Find accumulated impulses x >= 0 with relative normal velocities
+		// vn = K * x + b >= 0 and x_j * vn_j = 0, trying which points are active:
+		// both, only the first, only the second, none.
+		const uint32 p = 2 * i;
+		const KVector2 ra1 = c.ra[p], ra2 = c.ra[p + 1];
+		const KVector2 rb1 = c.rb[p], rb2 = c.rb[p + 1];
+		const KMatrix2& K = c.blockK[i];
+		const KVector2 a(c.normalImpulse[p], c.normalImpulse[p + 1]);
+
+		const KVector2 dv1 = vB + KVector2::Cross(wB, rb1) - vA - KVector2::Cross(wA, ra1);
+		const KVector2 dv2 = vB + KVector2::Cross(wB, rb2) - vA - KVector2::Cross(wA, ra2);
+		KVector2 b(KVector2::Dot(dv1, n) - c.bias[p], KVector2::Dot(dv2, n) - c.bias[p + 1]);
+		b -= K * a;
+
+		KVector2 x = -(c.blockNormalMass[i] * b);
+		if (x.x < 0.0f || x.y < 0.0f)
+		{
+			x.Set(-c.normalMass[p] * b.x, 0.0f);
+			const float vn2 = K._10 * x.x + b.y;
+			if (x.x < 0.0f || vn2 < 0.0f)
+			{
+				x.Set(0.0f, -c.normalMass[p + 1] * b.y);
+				const float vn1 = K._01 * x.y + b.x;
+				if (x.y < 0.0f || vn1 < 0.0f)
+				{
+					x.Set(0.0f, 0.0f);
+					// No solution, keep the impulses, this only happens on odd configurations
+					if (b.x < 0.0f || b.y < 0.0f)
+						x = a;
+				}
+			}
+		}
+
+		const KVector2 d = x - a;
+		const KVector2 P1 = d.x * n;
+		const KVector2 P2 = d.y * n;
+		vA -= mA * (P1 + P2);
+		wA -= invIA * (KVector2::Cross(ra1, P1) + KVector2::Cross(ra2, P2));
+		vB += mB * (P1 + P2);
+		wB += invIB * (KVector2::Cross(rb1, P1) + KVector2::Cross(rb2, P2));
+		c.normalImpulse[p] = x.x;
+		c.normalImpulse[p + 1] = x.y;
+		delta = __max(std::abs(d.x), std::abs(d.y));
+	}
+	else
+	{
+		for (uint32 j = 0; j < c.pointCount[i]; ++j)
+		{
+			const uint32 p = 2 * i + j;
+			const KVector2 ra = c.ra[p];
+			const KVector2 rb = c.rb[p];
+
+			// Normal impulse, clamped so the accumulated impulse only pushes
+			const KVector2 dv = vB + KVector2::Cross(wB, rb) - vA - KVector2::Cross(wA, ra);
+			const float vn = KVector2::Dot(dv, n);
+			float lambda = -c.normalMass[p] * (vn - c.bias[p]);
+			const float oldImpulse = c.normalImpulse[p];
+			c.normalImpulse[p] = __max(oldImpulse + lambda, 0.0f);
+			lambda = c.normalImpulse[p] - oldImpulse;
+			delta = __max(delta, std::abs(lambda));
+
+			const KVector2 P = lambda * n;
+			vA -= mA * P;
+			wA -= invIA * KVector2::Cross(ra, P);
+			vB += mB * P;
+			wB += invIB * KVector2::Cross(rb, P);
+		}
+	}
+
+	if (KWorld::enableFriction == true)
+	{
+		for (uint32 j = 0; j < c.pointCount[i]; ++j)
+		{
+			const uint32 p = 2 * i + j;
+			const KVector2 ra = c.ra[p];
+			const KVector2 rb = c.rb[p];
+
+			const KVector2 dv = vB + KVector2::Cross(wB, rb) - vA - KVector2::Cross(wA, ra);
+			const float vt = KVector2::Dot(dv, t);
+			float lambda = -c.tangentMass[p] * vt;
+
+			// Coulomb's law: stick while inside the static cone,
+			// otherwise slide with dynamic friction
+			const float oldTangent = c.tangentImpulse[p];
+			float newTangent = oldTangent + lambda;
+			if (std::abs(newTangent) > c.staticFriction[i] * c.normalImpulse[p])
+			{
+				const float maxFriction = c.dynamicFriction[i] * c.normalImpulse[p];
+				newTangent = Clamp(-maxFriction, maxFriction, newTangent);
+			}
+			c.tangentImpulse[p] = newTangent;
+			lambda = newTangent - oldTangent;
+			delta = __max(delta, std::abs(lambda));
+
+			const KVector2 P = lambda * t;
+			vA -= mA * P;
+			wA -= invIA * KVector2::Cross(ra, P);
+			vB += mB * P;
+			wB += invIB * KVector2::Cross(rb, P);
+		}
+	}
+
+	// Static bodies may be shared inside a colour, never write them
+	if (mA != 0.0f)
+	{
+		m_velocity[iA] = vA;
+		m_angularVelocity[iA] = wA;
+	}
+	if (mB != 0.0f)
+	{
+		m_velocity[iB] = vB;
+		m_angularVelocity[iB] = wB;
+	}
+	return delta;
+}
+
+void KContactSolver::StoreVelocities(KBodyStore& bodies)
+{
+	const uint32 numBodies = bodies.GetCount();
+	for (uint32 i = 0; i < numBodies; ++i)
+	{
+		if (bodies.invMass[i] == 0.0f)
+			continue;
+		bodies.velocity[i] = m_velocity[i];
+		bodies.angularVelocity[i] = m_angularVelocity[i];
+	}
+}
+
+void KContactSolver::_GatherPositions(const KBodyStore& bodies)
+{
+	m_position.assign(bodies.position.begin(), bodies.position.end());
+	m_rotation.assign(bodies.rotation.begin(), bodies.rotation.end());
+	m_position.push_back(KVector2::zero);
+	m_rotation.push_back(0.0f);
+}
+
+void KContactSolver::_StorePositions(KBodyStore& bodies)
+{
+	const uint32 numBodies = bodies.GetCount();
+	for (uint32 i = 0; i < numBodies; ++i)
+	{
+		if (bodies.invMass[i] == 0.0f)
+			continue;
+		bodies.position[i] = m_position[i];
+		bodies.rotation[i] = m_rotation[i];
+	}
+}
+
+void KContactSolver::SolvePositions(KBodyStore& bodies)
+{
+	_GatherPositions(bodies);
+
+	// Stop once no point is deeper than a few slops
+	const float tolerance = 3.0f * m_linearSlop;
+
+	m_stats.positionIterations = 0;
+	m_stats.positionError = 0.0f;
+
+	const uint32 numThreads = m_threadPool ? m_threadPool->GetThreadCount() : 1;
+	if (numThreads <= 1 || m_constraints.m_count < m_minParallelConstraints)
+	{
+		for (uint32 j = 0; j < m_positionIterations; ++j)
+		{
+			m_stats.positionError = _SolvePositionIteration(0, 1, nullptr);
+			m_stats.positionIterations = j + 1;
+			if (m_stats.positionError <= tolerance)
+				break;
+		}
+	}
+	else
+	{
+		m_threadValue.resize(numThreads);
+		KSpinBarrier barrier(numThreads);
+		m_threadPool->Dispatch(numThreads, [&](uint32 threadIndex)
+		{
+			for (uint32 j = 0; j < m_positionIterations; ++j)
+			{
+				const float error = _ReduceMax(threadIndex, numThreads, _SolvePositionIteration(threadIndex, numThreads, &barrier), barrier);
+				if (threadIndex == 0)
+				{
+					m_stats.positionError = error;
+					m_stats.positionIterations = j + 1;
+				}
+				if (error <= tolerance)
+					break;
+			}
+		});
+	}
+
+	_StorePositions(bodies);
+}
+
+float KContactSolver::_SolvePositionIteration(uint32 threadIndex, uint32 numThreads, KSpinBarrier* barrier)
+{
+	float error = 0.0f;
+	for (uint32 c = 0; c < k_maxColors; ++c)
+	{
+		uint32 b = m_colorOffsets[c];
+		uint32 e = m_colorOffsets[c + 1];
+		if (b == e)
+			continue;
+
+		_GetThreadRange(threadIndex, numThreads, 8, b, e);
+		for (uint32 i = b; i < e; ++i)
+		{
+			const float manifoldError = _SolvePositionManifold(i);
+			error = __max(error, manifoldError);
+		}
+
+		if (barrier)
+			barrier->Wait();
+	}
+
+	const uint32 overflowBegin = m_colorOffsets[k_maxColors];
+	const uint32 overflowEnd = m_colorOffsets[k_maxColors + 1];
+	if (overflowBegin != overflowEnd)
+	{
+		if (threadIndex == 0)
+		{
+			for (uint32 i = overflowBegin; i < overflowEnd; ++i)
+			{
+				const float manifoldError = _SolvePositionManifold(i);
+				error = __max(error, manifoldError);
+			}
+		}
+		if (barrier)
+			barrier->Wait();
+	}
+	return error;
+}
+
+// Returns the deepest penetration found before correcting
+float KContactSolver::_SolvePositionManifold(uint32 i)
+{
+	KContactConstraints& c = m_constraints;
+	const uint32 iA = c.indexA[i];
+	const uint32 iB = c.indexB[i];
+	const float mA = m_invMass[iA], mB = m_invMass[iB];
+	const float invIA = m_invI[iA], invIB = m_invI[iB];
+	const KVector2 n = c.normal[i];
+
+	KVector2 pA = m_position[iA];
+	KVector2 pB = m_position[iB];
+	float aA = m_rotation[iA];
+	float aB = m_rotation[iB];
+
+	float error = 0.0f;
+	for (uint32 j = 0; j < c.pointCount[i]; ++j)
+	{
+		const uint32 p = 2 * i + j;
+		const KVector2 ra = KMatrix2(aA) * c.localAnchorA[p];
+		const KVector2 rb = KMatrix2(aB) * c.localAnchorB[p];
+
+		// Both anchors started at the contact point, so their relative motion
+		// along the normal is how much the separation changed since
+		const float separation = KVector2::Dot((pB + rb) - (pA + ra), n) + c.separation[p];
+		error = __max(error, -separation);
+
+		// Keep a little overlap so the contact persists, and never push too far at once
+		const float C = Clamp(-m_maxLinearCorrection, 0.0f, m_baumgarte * (separation + m_linearSlop));
+
+		const float rnA = KVector2::Cross(ra, n);
+		const float rnB = KVector2::Cross(rb, n);
+		const float K = mA + mB + invIA * rnA * rnA + invIB * rnB * rnB;
+		const float impulse = K > 0.0f ? -C / K : 0.0f;
+
+		const KVector2 P = impulse * n;
+		pA -= mA * P;
+		aA -= invIA * KVector2::Cross(ra, P);
+		pB += mB * P;
+		aB += invIB * KVector2::Cross(rb, P);
+	}
+
+	if (mA != 0.0f)
+	{
+		m_position[iA] = pA;
+		m_rotation[iA] = aA;
+	}
+	if (mB != 0.0f)
+	{
+		m_position[iB] = pB;
+		m_rotation[iB] = aB;
+	}
+	return error;
+}
@@ -0,0 +1,235 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "KMath.h"
+#include "KSimd.h"
+
+struct KManifold;
+struct KRigidbody;
+class KMaterialTable;
+class KBodyStore;
+class KThreadPool;
+class KSpinBarrier;
+
+// Flat structure-of-arrays view of all contact constraints of one step.
+// Manifold data is stored once per manifold, point data in two slots per
+// manifold ([2 * i + 0], [2 * i + 1]) so a manifold's points stay adjacent.
+struct KContactConstraints
+{
+	void Resize(uint32 numManifolds);
+
+	uint32					m_count = 0;
+
+	// per manifold
+	std::vector<uint32>		indexA;
+	std::vector<uint32>		indexB;
+	std::vector<uint32>		pointCount;
+	std::vector<KVector2>	normal;
+	std::vector<KVector2>	tangent;
+	std::vector<float>		staticFriction;
+	std::vector<float>		dynamicFriction;
+	std::vector<uint32>		blockSolve;		// solve both normal impulses as one 2x2 LCP
+	std::vector<KMatrix2>	blockK;			// effective mass of the point pair
+	std::vector<KMatrix2>	blockNormalMass;	// inverse of blockK
+
+	// per contact point
+	std::vector<KVector2>	ra;				// COM of A to contact point
+	std::vector<KVector2>	rb;				// COM of B to contact point
+	std::vector<float>		normalMass;		// 1 / effective mass along normal
+	std::vector<float>		tangentMass;	// 1 / effective mass along tangent
+	std::vector<float>		bias;			// target separating velocity (restitution)
+	std::vector<float>		normalImpulse;	// accumulated over the iterations
+	std::vector<float>		tangentImpulse;
+	std::vector<KVector2>	localAnchorA;	// contact point in A's model space
+	std::vector<KVector2>	localAnchorB;	// contact point in B's model space
+	std::vector<float>		separation;		// separation when the contact was found (<= 0)
+	std::vector<float>		maxNormalImpulse;	// largest normal impulse of a soft step
+};
+
+// K_SIMD_WIDTH manifolds of the same colour packed lane by lane. Lanes never
+// share a dynamic body, so all of them are solved at once; unused lanes point
+// at the solver's dummy body which has no mass.
+struct alignas(32) KContactConstraintW
+{
+	uint32	indexA[K_SIMD_WIDTH];
+	uint32	indexB[K_SIMD_WIDTH];
+	float	invMassA[K_SIMD_WIDTH];
+	float	invMassB[K_SIMD_WIDTH];
+	float	invIA[K_SIMD_WIDTH];
+	float	invIB[K_SIMD_WIDTH];
+	float	normalX[K_SIMD_WIDTH];
+	float	normalY[K_SIMD_WIDTH];
+	float	staticFriction[K_SIMD_WIDTH];
+	float	dynamicFriction[K_SIMD_WIDTH];
+	float	blockSolve[K_SIMD_WIDTH];			// 1 or 0
+	float	blockK[4][K_SIMD_WIDTH];			// KMatrix2::v order
+	float	blockNormalMass[4][K_SIMD_WIDTH];
+
+	// per contact point, a manifold's second point is massless when unused
+	float	raX[2][K_SIMD_WIDTH];
+	float	raY[2][K_SIMD_WIDTH];
+	float	rbX[2][K_SIMD_WIDTH];
+	float	rbY[2][K_SIMD_WIDTH];
+	float	normalMass[2][K_SIMD_WIDTH];
+	float	tangentMass[2][K_SIMD_WIDTH];
+	float	bias[2][K_SIMD_WIDTH];
+	float	normalImpulse[2][K_SIMD_WIDTH];
+	float	tangentImpulse[2][K_SIMD_WIDTH];
+};
+
+// What the last step of a KContactSolver did
+struct KSolverStats
+{
+	uint32	numConstraints = 0;
+	uint32	velocityIterations = 0;	// iterations run by Solve()
+	uint32	positionIterations = 0;	// iterations run by SolvePositions()
+	float	impulseDelta = 0.0f;		// largest impulse change of the last velocity iteration
+	float	positionError = 0.0f;		// deepest penetration seen by the last position iteration
+};
+
+// Sequential impulse solver working on KContactConstraints and a copy of the
+// body store's velocity arrays, indexed by the bodies' dense index.
+//
+// Constraints are graph coloured so that no two manifolds of a colour share a
+// dynamic body (static bodies are never written). Each colour is stored as a
+// contiguous range and can be solved by several threads at once; manifolds
+// that do not fit into k_maxColors go to an overflow range solved by one thread.
+//
+// With m_useSimd the coloured ranges are repacked into KContactConstraintW
+// bundles and solved K_SIMD_WIDTH manifolds at a time; the overflow range is
+// always solved by the scalar path.
+//
+// After the velocities are integrated, SolvePositions() removes the remaining
+// penetration with nonlinear Gauss-Seidel: each contact point is anchored on
+// both bodies, so its separation is recomputed from the current positions
+// instead of reusing the penetration found before integration.
+//
+// SoftStep() replaces Solve() and SolvePositions() with sub-stepping: the
+// step's contacts are reused by every sub-step, which integrates, solves once
+// against soft contacts and relaxes once without the position bias.
+class KContactSolver
+{
+public:
+	static const uint32 k_maxColors = 24;
+
+	void SetThreadPool(KThreadPool* threadPool) { m_threadPool = threadPool; }
+	// Gathers body velocities, colours the manifolds and builds the constraint arrays.
+	void Initialize(const KBodyStore& bodies, const std::vector<KManifold>& contacts,
+		const KMaterialTable& materials, float dt);
+	// Runs at least minIterations and at most maxIterations velocity iterations,
+	// stopping once no impulse changes by more than m_impulseTolerance.
+	// Runs in parallel when there are enough constraints.
+	void Solve(uint32 minIterations, uint32 maxIterations);
+	// Writes the solved velocities back to the store.
+	void StoreVelocities(KBodyStore& bodies);
+	// Pushes the integrated bodies apart, call after the positions were integrated.
+	void SolvePositions(KBodyStore& bodies);
+	// Integrates forces, velocities and positions over dt in subSteps sub-steps and
+	// writes the result back to the bodies, call instead of the functions above.
+	// Contacts push apart like a spring of contactHertz with the given damping ratio.
+	void SoftStep(KBodyStore& bodies, float dt, uint32 subSteps,
+		float contactHertz, float contactDampingRatio);
+
+	const KContactConstraints& GetConstraints() const { return m_constraints; }
+	// Constraint range of colour c is [offsets[c], offsets[c + 1]), c == k_maxColors is the overflow
+	const std::vector<uint32>& GetColorOffsets() const { return m_colorOffsets; }
+	const KSolverStats& GetStats() const { return m_stats; }
+
+	// Below this many manifolds the solve stays on the calling thread
+	uint32					m_minParallelConstraints = 256;
+	// Solve the coloured constraints with the wide kernel
+	bool					m_useSimd = true;
+	// Velocity iterations stop once the largest impulse change drops below this
+	float					m_impulseTolerance = 1e-3f;
+	// Two-point manifolds are block solved while cond(K) stays below this
+	float					m_maxBlockCondition = 1000.0f;
+
+	// Position correction
+	uint32					m_positionIterations = 3;
+	float					m_linearSlop = 0.05f;			// penetration allowance
+	float					m_baumgarte = 0.2f;				// fraction of the error removed per iteration
+	float					m_maxLinearCorrection = 0.2f;	// prevents large pushes on deep overlaps
+	float					m_maxPushVelocity = 3.0f;		// soft step: fastest speed overlaps are resolved with
+
+private:
+	void _Colorize(const std::vector<KManifold>& contacts);
+	// The solve functions return the largest impulse change they applied
+	float _SolveIteration(uint32 threadIndex, uint32 numThreads, KSpinBarrier* barrier);
+	float _SolveRange(uint32 begin, uint32 end);
+	float _SolveManifold(uint32 i);
+	float _SolvePositionIteration(uint32 threadIndex, uint32 numThreads, KSpinBarrier* barrier);
+	float _SolvePositionManifold(uint32 i);
+	// Part of [begin, end) solved by threadIndex, small ranges stay on thread 0
+	static void _GetThreadRange(uint32 threadIndex, uint32 numThreads, uint32 minPerThread, uint32& begin, uint32& end);
+	// Maximum of value over all threads of the current Dispatch()
+	float _ReduceMax(uint32 threadIndex, uint32 numThreads, float value, KSpinBarrier& barrier);
+	void _GatherPositions(const KBodyStore& bodies);
+	void _StorePositions(KBodyStore& bodies);
+	// KContactSolverSIMD.cpp
+	void _PrepareWide();
+	float _SolveWideRange(uint32 begin, uint32 end);
+	// KContactSolverSoft.cpp
+	typedef void (KContactSolver::*ManifoldFunc)(uint32 i);
+	void _SoftSubStep(uint32 threadIndex, uint32 numThreads, KSpinBarrier* barrier);
+	void _SoftPass(uint32 threadIndex, uint32 numThreads, KSpinBarrier* barrier, ManifoldFunc func);
+	void _IntegrateVelocities(uint32 begin, uint32 end);
+	void _IntegratePositions(uint32 begin, uint32 end);
+	void _WarmStartManifold(uint32 i);
+	void _SoftSolveManifold(uint32 i);
+	void _RelaxManifold(uint32 i);
+	void _SoftContact(uint32 i, bool useBias);
+	void _RestituteManifold(uint32 i);
+
+private:
+	struct PairKeyHash
+	{
+		std::size_t operator()(const std::pair<const KRigidbody*, const KRigidbody*>& p) const {
+			return std::hash<const KRigidbody*>()(p.first) ^ (std::hash<const KRigidbody*>()(p.second) << 1);
+		}
+	};
+	typedef std::unordered_map<std::pair<const KRigidbody*, const KRigidbody*>, uint32, PairKeyHash> PairColorMap;
+
+	KContactConstraints		m_constraints;
+	KThreadPool*			m_threadPool = nullptr;
+	KSolverStats			m_stats;
+
+	// colouring
+	std::vector<uint32>		m_colorOffsets;		// k_maxColors + 2 entries
+	std::vector<uint32>		m_bodyColors;		// bit c set: body already used by colour c
+	std::vector<uint32>		m_manifoldColor;
+	std::vector<uint32>		m_manifoldSlot;		// constraint index of each manifold
+	PairColorMap			m_pairColors;		// previous step's colours, used as hints
+	PairColorMap			m_nextPairColors;
+
+	// wide layout, bundle range of colour c is [m_wideColorOffsets[c], m_wideColorOffsets[c + 1])
+	bool								m_isWide = false;
+	std::vector<KContactConstraintW>	m_wideConstraints;
+	std::vector<uint32>					m_wideColorOffsets;
+
+	// per body, indexed by KBodyStore::GetIndex(). One extra massless
+	// dummy body at the end backs the unused SIMD lanes.
+	std::vector<KVector2>	m_velocity;
+	std::vector<float>		m_angularVelocity;
+	std::vector<float>		m_invMass;
+	std::vector<float>		m_invI;
+	std::vector<KVector2>	m_position;
+	std::vector<float>		m_rotation;
+	std::vector<KVector2>	m_linearAcceleration;	// soft step: forces and gravity
+	std::vector<float>		m_angularAcceleration;
+	std::vector<float>		m_linearDecay;			// soft step: velocity scale per sub-step, see KBodyStore
+	std::vector<float>		m_angularDecay;
+
+	// soft step settings, see KContactSolverSoft.cpp
+	struct Softness
+	{
+		float biasRate;		// fraction of the separation turned into velocity per second
+		float massScale;
+		float impulseScale;
+	};
+	Softness				m_softness;
+	float					m_subStepDt = 0.0f;
+	float					m_invSubStepDt = 0.0f;
+
+	std::vector<float>		m_threadValue;	// _ReduceMax() scratch
+};
@@ -0,0 +1,247 @@
+#include "KContactSolver.h"
+#include "KPhysicsEngine.h"
+
+// Wide version of KContactSolver::_SolveManifold(). The arithmetic is kept in
+// the same order as the scalar path, so both agree to within rounding.
+
+void KContactSolver::_PrepareWide()
+{
+	const KContactConstraints& c = m_constraints;
+	const uint32 dummy = (uint32)m_invMass.size() - 1;
+
+	// Count bundles per colour
+	m_wideColorOffsets.assign(k_maxColors + 1, 0);
+	for (uint32 color = 0; color < k_maxColors; ++color)
+	{
+		const uint32 count = m_colorOffsets[color + 1] - m_colorOffsets[color];
+		m_wideColorOffsets[color + 1] = m_wideColorOffsets[color] + (count + K_SIMD_WIDTH - 1) / K_SIMD_WIDTH;
+	}
+	m_wideConstraints.resize(m_wideColorOffsets[k_maxColors]);
+
+	for (uint32 color = 0; color < k_maxColors; ++color)
+	{
+		const uint32 begin = m_colorOffsets[color];
+		const uint32 end = m_colorOffsets[color + 1];
+		for (uint32 w = m_wideColorOffsets[color]; w < m_wideColorOffsets[color + 1]; ++w)
+		{
+			KContactConstraintW& wc = m_wideConstraints[w];
+			const uint32 first = begin + (w - m_wideColorOffsets[color]) * K_SIMD_WIDTH;
+			for (uint32 lane = 0; lane < K_SIMD_WIDTH; ++lane)
+			{
+				const uint32 i = first + lane;
+				const bool used = i < end;
+				const uint32 iA = used ? c.indexA[i] : dummy;
+				const uint32 iB = used ? c.indexB[i] : dummy;
+				wc.indexA[lane] = iA;
+				wc.indexB[lane] = iB;
+				wc.invMassA[lane] = m_invMass[iA];
+				wc.invMassB[lane] = m_invMass[iB];
+				wc.invIA[lane] = m_invI[iA];
+				wc.invIB[lane] = m_invI[iB];
+				wc.normalX[lane] = used ? c.normal[i].x : 0.0f;
+				wc.normalY[lane] = used ? c.normal[i].y : 0.0f;
+				wc.staticFriction[lane] = used ? c.staticFriction[i] : 0.0f;
+				wc.dynamicFriction[lane] = used ? c.dynamicFriction[i] : 0.0f;
+				const bool block = used && c.blockSolve[i] != 0;
+				wc.blockSolve[lane] = block ? 1.0f : 0.0f;
+				for (uint32 k = 0; k < 4; ++k)
+				{
+					wc.blockK[k][lane] = block ? c.blockK[i].v[k] : 0.0f;
+					wc.blockNormalMass[k][lane] = block ? c.blockNormalMass[i].v[k] : 0.0f;
+				}
+
+				for (uint32 j = 0; j < 2; ++j)
+				{
+					const bool usedPoint = used && j < c.pointCount[i];
+					const uint32 p = 2 * i + j;
+					wc.raX[j][lane] = usedPoint ? c.ra[p].x : 0.0f;
+					wc.raY[j][lane] = usedPoint ? c.ra[p].y : 0.0f;
+					wc.rbX[j][lane] = usedPoint ? c.rb[p].x : 0.0f;
+					wc.rbY[j][lane] = usedPoint ? c.rb[p].y : 0.0f;
+					wc.normalMass[j][lane] = usedPoint ? c.normalMass[p] : 0.0f;
+					wc.tangentMass[j][lane] = usedPoint ? c.tangentMass[p] : 0.0f;
+					wc.bias[j][lane] = usedPoint ? c.bias[p] : 0.0f;
+					wc.normalImpulse[j][lane] = 0.0f;
+					wc.tangentImpulse[j][lane] = 0.0f;
+				}
+			}
+		}
+	}
+}
+
+float KContactSolver::_SolveWideRange(uint32 begin, uint32 end)
+{
+	KFloatW delta = KZeroW();
+	alignas(32) float vAX[K_SIMD_WIDTH], vAY[K_SIMD_WIDTH], wAs[K_SIMD_WIDTH];
+	alignas(32) float vBX[K_SIMD_WIDTH], vBY[K_SIMD_WIDTH], wBs[K_SIMD_WIDTH];
+
+	for (uint32 w = begin; w < end; ++w)
+	{
+		KContactConstraintW& c = m_wideConstraints[w];
+
+		// Gather
+		for (uint32 lane = 0; lane < K_SIMD_WIDTH; ++lane)
+		{
+			const KVector2& vA = m_velocity[c.indexA[lane]];
+			const KVector2& vB = m_velocity[c.indexB[lane]];
+			vAX[lane] = vA.x; vAY[lane] = vA.y; wAs[lane] = m_angularVelocity[c.indexA[lane]];
+			vBX[lane] = vB.x; vBY[lane] = vB.y; wBs[lane] = m_angularVelocity[c.indexB[lane]];
+		}
+		KFloatW vAx = KLoadW(vAX), vAy = KLoadW(vAY), wA = KLoadW(wAs);
+		KFloatW vBx = KLoadW(vBX), vBy = KLoadW(vBY), wB = KLoadW(wBs);
+
+		const KFloatW mA = KLoadW(c.invMassA), mB = KLoadW(c.invMassB);
+		const KFloatW iA = KLoadW(c.invIA), iB = KLoadW(c.invIB);
+		const KFloatW nx = KLoadW(c.normalX), ny = KLoadW(c.normalY);
+		// tangent = Cross(normal, 1)
+		const KFloatW tx = ny, ty = KNegW(nx);
+
+		// Normal impulses. Both the per point and the block solution are
+		// computed from the same velocities, each lane keeps the one it uses.
+		KFloatW sAx = vAx, sAy = vAy, sA = wA, sBx = vBx, sBy = vBy, sB = wB;
+		KFloatW seqImpulse[2];
+		KFloatW seqDelta = KZeroW();
+		for (uint32 j = 0; j < 2; ++j)
+		{
+			const KFloatW rax = KLoadW(c.raX[j]), ray = KLoadW(c.raY[j]);
+			const KFloatW rbx = KLoadW(c.rbX[j]), rby = KLoadW(c.rbY[j]);
+
+			const KFloatW dvx = KAddW(KSubW(KSubW(sBx, KMulW(sB, rby)), sAx), KMulW(sA, ray));
+			const KFloatW dvy = KSubW(KSubW(KAddW(sBy, KMulW(sB, rbx)), sAy), KMulW(sA, rax));
+			const KFloatW vn = KAddW(KMulW(dvx, nx), KMulW(dvy, ny));
+			KFloatW lambda = KNegW(KMulW(KLoadW(c.normalMass[j]), KSubW(vn, KLoadW(c.bias[j]))));
+			const KFloatW oldImpulse = KLoadW(c.normalImpulse[j]);
+			seqImpulse[j] = KMaxW(KAddW(oldImpulse, lambda), KZeroW());
+			lambda = KSubW(seqImpulse[j], oldImpulse);
+			seqDelta = KMaxW(seqDelta, KAbsW(lambda));
+
+			const KFloatW Px = KMulW(lambda, nx), Py = KMulW(lambda, ny);
+			sAx = KSubW(sAx, KMulW(mA, Px));
+			sAy = KSubW(sAy, KMulW(mA, Py));
+			sA = KSubW(sA, KMulW(iA, KSubW(KMulW(rax, Py), KMulW(ray, Px))));
+			sBx = KAddW(sBx, KMulW(mB, Px));
+			sBy = KAddW(sBy, KMulW(mB, Py));
+			sB = KAddW(sB, KMulW(iB, KSubW(KMulW(rbx, Py), KMulW(rby, Px))));
+		}
+
+		const KFloatW block = KGreaterW(KLoadW(c.blockSolve), KZeroW());
+		{
+			// Block solve, see _SolveManifold()
+			const KFloatW ra1x = KLoadW(c.raX[0]), ra1y = KLoadW(c.raY[0]);
+			const KFloatW ra2x = KLoadW(c.raX[1]), ra2y = KLoadW(c.raY[1]);
+			const KFloatW rb1x = KLoadW(c.rbX[0]), rb1y = KLoadW(c.rbY[0]);
+			const KFloatW rb2x = KLoadW(c.rbX[1]), rb2y = KLoadW(c.rbY[1]);
+			const KFloatW k00 = KLoadW(c.blockK[0]), k01 = KLoadW(c.blockK[1]);
+			const KFloatW k10 = KLoadW(c.blockK[2]), k11 = KLoadW(c.blockK[3]);
+			const KFloatW m00 = KLoadW(c.blockNormalMass[0]), m01 = KLoadW(c.blockNormalMass[1]);
+			const KFloatW m10 = KLoadW(c.blockNormalMass[2]), m11 = KLoadW(c.blockNormalMass[3]);
+			const KFloatW a1 = KLoadW(c.normalImpulse[0]), a2 = KLoadW(c.normalImpulse[1]);
+
+			const KFloatW dv1x = KAddW(KSubW(KSubW(vBx, KMulW(wB, rb1y)), vAx), KMulW(wA, ra1y));
+			const KFloatW dv1y = KSubW(KSubW(KAddW(vBy, KMulW(wB, rb1x)), vAy), KMulW(wA, ra1x));
+			const KFloatW dv2x = KAddW(KSubW(KSubW(vBx, KMulW(wB, rb2y)), vAx), KMulW(wA, ra2y));
+			const KFloatW dv2y = KSubW(KSubW(KAddW(vBy, KMulW(wB, rb2x)), vAy), KMulW(wA, ra2x));
+			KFloatW b1 = KSubW(KAddW(KMulW(dv1x, nx), KMulW(dv1y, ny)), KLoadW(c.bias[0]));
+			KFloatW b2 = KSubW(KAddW(KMulW(dv2x, nx), KMulW(dv2y, ny)), KLoadW(c.bias[1]));
+			const KFloatW Ka1 = KAddW(KMulW(k00, a1), KMulW(k01, a2));
+			const KFloatW Ka2 = KAddW(KMulW(k10, a1), KMulW(k11, a2));
+			b1 = KSubW(b1, Ka1);
+			b2 = KSubW(b2, Ka2);
+
+			const KFloatW zero = KZeroW();
+			// both points
+			const KFloatW x1Both = KNegW(KAddW(KMulW(m00, b1), KMulW(m01, b2)));
+			const KFloatW x2Both = KNegW(KAddW(KMulW(m10, b1), KMulW(m11, b2)));
+			const KFloatW failBoth = KOrW(KGreaterW(zero, x1Both), KGreaterW(zero, x2Both));
+			// first point only
+			const KFloatW x1First = KNegW(KMulW(KLoadW(c.normalMass[0]), b1));
+			const KFloatW vn2First = KAddW(KMulW(k10, x1First), b2);
+			const KFloatW failFirst = KOrW(KGreaterW(zero, x1First), KGreaterW(zero, vn2First));
+			// second point only
+			const KFloatW x2Second = KNegW(KMulW(KLoadW(c.normalMass[1]), b2));
+			const KFloatW vn1Second = KAddW(KMulW(k01, x2Second), b1);
+			const KFloatW failSecond = KOrW(KGreaterW(zero, x2Second), KGreaterW(zero, vn1Second));
+			// none, or no solution at all
+			const KFloatW failNone = KOrW(KGreaterW(zero, b1), KGreaterW(zero, b2));
+
+			KFloatW x1 = KBlendW(zero, a1, failNone);
+			KFloatW x2 = KBlendW(zero, a2, failNone);
+			x1 = KBlendW(zero, x1, failSecond);
+			x2 = KBlendW(x2Second, x2, failSecond);
+			x1 = KBlendW(x1First, x1, failFirst);
+			x2 = KBlendW(zero, x2, failFirst);
+			x1 = KBlendW(x1Both, x1, failBoth);
+			x2 = KBlendW(x2Both, x2, failBoth);
+
+			const KFloatW d1 = KSubW(x1, a1), d2 = KSubW(x2, a2);
+			const KFloatW P1x = KMulW(d1, nx), P1y = KMulW(d1, ny);
+			const KFloatW P2x = KMulW(d2, nx), P2y = KMulW(d2, ny);
+			const KFloatW Px = KAddW(P1x, P2x), Py = KAddW(P1y, P2y);
+			const KFloatW crossA = KAddW(KSubW(KMulW(ra1x, P1y), KMulW(ra1y, P1x)), KSubW(KMulW(ra2x, P2y), KMulW(ra2y, P2x)));
+			const KFloatW crossB = KAddW(KSubW(KMulW(rb1x, P1y), KMulW(rb1y, P1x)), KSubW(KMulW(rb2x, P2y), KMulW(rb2y, P2x)));
+
+			vAx = KBlendW(sAx, KSubW(vAx, KMulW(mA, Px)), block);
+			vAy = KBlendW(sAy, KSubW(vAy, KMulW(mA, Py)), block);
+			wA = KBlendW(sA, KSubW(wA, KMulW(iA, crossA)), block);
+			vBx = KBlendW(sBx, KAddW(vBx, KMulW(mB, Px)), block);
+			vBy = KBlendW(sBy, KAddW(vBy, KMulW(mB, Py)), block);
+			wB = KBlendW(sB, KAddW(wB, KMulW(iB, crossB)), block);
+			KStoreW(c.normalImpulse[0], KBlendW(seqImpulse[0], x1, block));
+			KStoreW(c.normalImpulse[1], KBlendW(seqImpulse[1], x2, block));
+			delta = KMaxW(delta, KBlendW(seqDelta, KMaxW(KAbsW(d1), KAbsW(d2)), block));
+		}
+
+		if (KWorld::enableFriction == true)
+		{
+			for (uint32 j = 0; j < 2; ++j)
+			{
+				const KFloatW rax = KLoadW(c.raX[j]), ray = KLoadW(c.raY[j]);
+				const KFloatW rbx = KLoadW(c.rbX[j]), rby = KLoadW(c.rbY[j]);
+				const KFloatW normalImpulse = KLoadW(c.normalImpulse[j]);
+
+				const KFloatW dvx = KAddW(KSubW(KSubW(vBx, KMulW(wB, rby)), vAx), KMulW(wA, ray));
+				const KFloatW dvy = KSubW(KSubW(KAddW(vBy, KMulW(wB, rbx)), vAy), KMulW(wA, rax));
+				const KFloatW vt = KAddW(KMulW(dvx, tx), KMulW(dvy, ty));
+				KFloatW lambda = KNegW(KMulW(KLoadW(c.tangentMass[j]), vt));
+
+				// Coulomb's law, see _SolveManifold()
+				const KFloatW oldTangent = KLoadW(c.tangentImpulse[j]);
+				KFloatW newTangent = KAddW(oldTangent, lambda);
+				const KFloatW sliding = KGreaterW(KAbsW(newTangent), KMulW(KLoadW(c.staticFriction), normalImpulse));
+				const KFloatW maxFriction = KMulW(KLoadW(c.dynamicFriction), normalImpulse);
+				const KFloatW clamped = KMaxW(KMinW(newTangent, maxFriction), KNegW(maxFriction));
+				newTangent = KBlendW(newTangent, clamped, sliding);
+				KStoreW(c.tangentImpulse[j], newTangent);
+				lambda = KSubW(newTangent, oldTangent);
+				delta = KMaxW(delta, KAbsW(lambda));
+
+				const KFloatW Px = KMulW(lambda, tx);
+				const KFloatW Py = KMulW(lambda, ty);
+				vAx = KSubW(vAx, KMulW(mA, Px));
+				vAy = KSubW(vAy, KMulW(mA, Py));
+				wA = KSubW(wA, KMulW(iA, KSubW(KMulW(rax, Py), KMulW(ray, Px))));
+				vBx = KAddW(vBx, KMulW(mB, Px));
+				vBy = KAddW(vBy, KMulW(mB, Py));
+				wB = KAddW(wB, KMulW(iB, KSubW(KMulW(rbx, Py), KMulW(rby, Px))));
+			}
+		}
+
+		// Scatter, static bodies and the dummy are never written
+		KStoreW(vAX, vAx); KStoreW(vAY, vAy); KStoreW(wAs, wA);
+		KStoreW(vBX, vBx); KStoreW(vBY, vBy); KStoreW(wBs, wB);
+		for (uint32 lane = 0; lane < K_SIMD_WIDTH; ++lane)
+		{
+			if (c.invMassA[lane] != 0.0f)
+			{
+				m_velocity[c.indexA[lane]].Set(vAX[lane], vAY[lane]);
+				m_angularVelocity[c.indexA[lane]] = wAs[lane];
+			}
+			if (c.invMassB[lane] != 0.0f)
+			{
+				m_velocity[c.indexB[lane]].Set(vBX[lane], vBY[lane]);
+				m_angularVelocity[c.indexB[lane]] = wBs[lane];
+			}
+		}
+	}
+	return KReduceMaxW(delta);
+}
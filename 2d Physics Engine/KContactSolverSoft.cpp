@@ -0,0 +1,357 @@
+#include "KContactSolver.h"
+#include "KPhysicsEngine.h"
+#include "KThreadPool.h"
+
+// Sub-stepped solver with soft contacts (Catto, "Solver2D" soft step).
+//
+// Every sub-step integrates the velocities, warm starts with the impulses of
+// the previous sub-step, solves once with a position bias, integrates the
+// positions and solves once more without the bias ("relax") so the bias does
+// not turn into bounce. Restitution is applied once after the last sub-step.
+//
+// The contact bias is a damped spring: contactHertz sets how fast overlaps
+// are pushed out, the damping ratio how much of that push may overshoot.
+
+void KContactSolver::SoftStep(KBodyStore& bodies, float dt, uint32 subSteps,
+	float contactHertz, float contactDampingRatio)
+{
+	assert(subSteps > 0);
+	const uint32 numBodies = bodies.GetCount();
+	const float h = dt / (float)subSteps;
+	m_subStepDt = h;
+	m_invSubStepDt = 1.0f / h;
+
+	// A spring stiffer than a quarter of the sub-step rate is not stable
+	const float hertz = __min(contactHertz, 0.25f * m_invSubStepDt);
+	if (hertz > 0.0f)
+	{
+		const float omega = 2.0f * PI * hertz;
+		const float a1 = 2.0f * contactDampingRatio + h * omega;
+		const float a2 = h * omega * a1;
+		const float a3 = 1.0f / (1.0f + a2);
+		m_softness.biasRate = omega / a1;
+		m_softness.massScale = a2 * a3;
+		m_softness.impulseScale = a3;
+	}
+	else
+	{
+		m_softness.biasRate = 0.0f;
+		m_softness.massScale = 1.0f;
+		m_softness.impulseScale = 0.0f;
+	}
+
+	// Forces are constant over the step, see IntegrateForces(). The decay
+	// factors are cached by the store like the ones of the classic step.
+	_GatherPositions(bodies);
+	bodies.SetSubStepDecayDt(h);
+	m_linearAcceleration.resize(numBodies + 1);
+	m_angularAcceleration.resize(numBodies + 1);
+	m_linearDecay.resize(numBodies + 1);
+	m_angularDecay.resize(numBodies + 1);
+	for (uint32 i = 0; i < numBodies; ++i)
+	{
+		m_linearAcceleration[i] = bodies.force[i] * bodies.invMass[i] + KWorld::gravity;
+		m_angularAcceleration[i] = bodies.torque[i] * bodies.invInertia[i];
+		m_linearDecay[i] = bodies.subStepLinearDecay[i];
+		m_angularDecay[i] = bodies.subStepAngularDecay[i];
+	}
+	m_linearAcceleration[numBodies] = KVector2::zero;
+	m_angularAcceleration[numBodies] = 0.0f;
+	m_linearDecay[numBodies] = 1.0f;
+	m_angularDecay[numBodies] = 1.0f;
+
+	m_stats.numConstraints = m_constraints.m_count;
+	m_stats.velocityIterations = subSteps;
+	m_stats.positionIterations = 0;
+	m_stats.impulseDelta = 0.0f;
+	m_stats.positionError = 0.0f;
+
+	const uint32 numThreads = m_threadPool ? m_threadPool->GetThreadCount() : 1;
+	if (numThreads <= 1 || m_constraints.m_count < m_minParallelConstraints)
+	{
+		for (uint32 j = 0; j < subSteps; ++j)
+			_SoftSubStep(0, 1, nullptr);
+		_SoftPass(0, 1, nullptr, &KContactSolver::_RestituteManifold);
+	}
+	else
+	{
+		KSpinBarrier barrier(numThreads);
+		m_threadPool->Dispatch(numThreads, [&](uint32 threadIndex)
+		{
+			for (uint32 j = 0; j < subSteps; ++j)
+				_SoftSubStep(threadIndex, numThreads, &barrier);
+			_SoftPass(threadIndex, numThreads, &barrier, &KContactSolver::_RestituteManifold);
+		});
+	}
+
+	StoreVelocities(bodies);
+	_StorePositions(bodies);
+}
+
+void KContactSolver::_SoftSubStep(uint32 threadIndex, uint32 numThreads, KSpinBarrier* barrier)
+{
+	const uint32 numBodies = (uint32)m_velocity.size() - 1;
+	uint32 begin = 0, end = numBodies;
+	_GetThreadRange(threadIndex, numThreads, 64, begin, end);
+
+	_IntegrateVelocities(begin, end);
+	if (barrier)
+		barrier->Wait();
+
+	_SoftPass(threadIndex, numThreads, barrier, &KContactSolver::_WarmStartManifold);
+	_SoftPass(threadIndex, numThreads, barrier, &KContactSolver::_SoftSolveManifold);
+
+	_IntegratePositions(begin, end);
+	if (barrier)
+		barrier->Wait();
+
+	_SoftPass(threadIndex, numThreads, barrier, &KContactSolver::_RelaxManifold);
+}
+
+void KContactSolver::_SoftPass(uint32 threadIndex, uint32 numThreads, KSpinBarrier* barrier, ManifoldFunc func)
+{
+	for (uint32 c = 0; c < k_maxColors; ++c)
+	{
+		uint32 b = m_colorOffsets[c];
+		uint32 e = m_colorOffsets[c + 1];
+		if (b == e)
+			continue;
+
+		_GetThreadRange(threadIndex, numThreads, 8, b, e);
+		for (uint32 i = b; i < e; ++i)
+			(this->*func)(i);
+
+		if (barrier)
+			barrier->Wait();
+	}
+
+	const uint32 overflowBegin = m_colorOffsets[k_maxColors];
+	const uint32 overflowEnd = m_colorOffsets[k_maxColors + 1];
+	if (overflowBegin != overflowEnd)
+	{
+		if (threadIndex == 0)
+		{
+			for (uint32 i = overflowBegin; i < overflowEnd; ++i)
+				(this->*func)(i);
+		}
+		if (barrier)
+			barrier->Wait();
+	}
+}
+
+void KContactSolver::_IntegrateVelocities(uint32 begin, uint32 end)
+{
+	const float h = m_subStepDt;
+	for (uint32 i = begin; i < end; ++i)
+	{
+		if (m_invMass[i] == 0.0f)
+			continue;
+		m_velocity[i] += m_linearAcceleration[i] * h;
+		m_angularVelocity[i] += m_angularAcceleration[i] * h;
+		m_velocity[i] *= m_linearDecay[i];
+		m_angularVelocity[i] *= m_angularDecay[i];
+	}
+}
+
+void KContactSolver::_IntegratePositions(uint32 begin, uint32 end)
+{
+	const float h = m_subStepDt;
+	for (uint32 i = begin; i < end; ++i)
+	{
+		if (m_invMass[i] == 0.0f)
+			continue;
+		m_position[i] += m_velocity[i] * h;
+		m_rotation[i] += m_angularVelocity[i] * h;
+	}
+}
+
+void KContactSolver::_WarmStartManifold(uint32 i)
+{
+	KContactConstraints& c = m_constraints;
+	const uint32 iA = c.indexA[i];
+	const uint32 iB = c.indexB[i];
+	const float mA = m_invMass[iA], mB = m_invMass[iB];
+	const float invIA = m_invI[iA], invIB = m_invI[iB];
+
+	KVector2 vA = m_velocity[iA];
+	KVector2 vB = m_velocity[iB];
+	float wA = m_angularVelocity[iA];
+	float wB = m_angularVelocity[iB];
+
+	for (uint32 j = 0; j < c.pointCount[i]; ++j)
+	{
+		const uint32 p = 2 * i + j;
+		const KVector2 P = c.normalImpulse[p] * c.normal[i] + c.tangentImpulse[p] * c.tangent[i];
+		vA -= mA * P;
+		wA -= invIA * KVector2::Cross(c.ra[p], P);
+		vB += mB * P;
+		wB += invIB * KVector2::Cross(c.rb[p], P);
+	}
+
+	if (mA != 0.0f)
+	{
+		m_velocity[iA] = vA;
+		m_angularVelocity[iA] = wA;
+	}
+	if (mB != 0.0f)
+	{
+		m_velocity[iB] = vB;
+		m_angularVelocity[iB] = wB;
+	}
+}
+
+void KContactSolver::_SoftSolveManifold(uint32 i)
+{
+	_SoftContact(i, true);
+}
+
+void KContactSolver::_RelaxManifold(uint32 i)
+{
+	_SoftContact(i, false);
+}
+
+void KContactSolver::_SoftContact(uint32 i, bool useBias)
+{
+	KContactConstraints& c = m_constraints;
+	const uint32 iA = c.indexA[i];
+	const uint32 iB = c.indexB[i];
+	const float mA = m_invMass[iA], mB = m_invMass[iB];
+	const float invIA = m_invI[iA], invIB = m_invI[iB];
+	const KVector2 n = c.normal[i];
+	const KVector2 t = c.tangent[i];
+	const KVector2 pA = m_position[iA];
+	const KVector2 pB = m_position[iB];
+	const KMatrix2 rotA(m_rotation[iA]);
+	const KMatrix2 rotB(m_rotation[iB]);
+
+	KVector2 vA = m_velocity[iA];
+	KVector2 vB = m_velocity[iB];
+	float wA = m_angularVelocity[iA];
+	float wB = m_angularVelocity[iB];
+
+	for (uint32 j = 0; j < c.pointCount[i]; ++j)
+	{
+		const uint32 p = 2 * i + j;
+		const KVector2 ra = c.ra[p];
+		const KVector2 rb = c.rb[p];
+
+		// Current separation, see _SolvePositionManifold()
+		const float separation = KVector2::Dot((pB + rotB * c.localAnchorB[p]) - (pA + rotA * c.localAnchorA[p]), n) + c.separation[p];
+
+		float bias = 0.0f;
+		float massScale = 1.0f;
+		float impulseScale = 0.0f;
+		if (separation > 0.0f)
+		{
+			// Apart by now, only keep the bodies from closing the gap this sub-step
+			bias = separation * m_invSubStepDt;
+		}
+		else if (useBias)
+		{
+			// Leave m_linearSlop of overlap so the contact is found again next step
+			const float C = __min(separation + m_linearSlop, 0.0f);
+			bias = __max(m_softness.biasRate * C, -m_maxPushVelocity);
+			massScale = m_softness.massScale;
+			impulseScale = m_softness.impulseScale;
+		}
+
+		KVector2 dv = vB + KVector2::Cross(wB, rb) - vA - KVector2::Cross(wA, ra);
+		const float vn = KVector2::Dot(dv, n);
+		float lambda = -c.normalMass[p] * massScale * (vn + bias) - impulseScale * c.normalImpulse[p];
+		const float oldImpulse = c.normalImpulse[p];
+		c.normalImpulse[p] = __max(oldImpulse + lambda, 0.0f);
+		c.maxNormalImpulse[p] = __max(c.maxNormalImpulse[p], c.normalImpulse[p]);
+		lambda = c.normalImpulse[p] - oldImpulse;
+
+		KVector2 P = lambda * n;
+		vA -= mA * P;
+		wA -= invIA * KVector2::Cross(ra, P);
+		vB += mB * P;
+		wB += invIB * KVector2::Cross(rb, P);
+
+		if (KWorld::enableFriction == true)
+		{
+			dv = vB + KVector2::Cross(wB, rb) - vA - KVector2::Cross(wA, ra);
+			const float vt = KVector2::Dot(dv, t);
+			lambda = -c.tangentMass[p] * vt;
+
+			// Coulomb's law, see _SolveManifold()
+			const float oldTangent = c.tangentImpulse[p];
+			float newTangent = oldTangent + lambda;
+			if (std::abs(newTangent) > c.staticFriction[i] * c.normalImpulse[p])
+			{
+				const float maxFriction = c.dynamicFriction[i] * c.normalImpulse[p];
+				newTangent = Clamp(-maxFriction, maxFriction, newTangent);
+			}
+			c.tangentImpulse[p] = newTangent;
+			lambda = newTangent - oldTangent;
+
+			P = lambda * t;
+			vA -= mA * P;
+			wA -= invIA * KVector2::Cross(ra, P);
+			vB += mB * P;
+			wB += invIB * KVector2::Cross(rb, P);
+		}
+	}
+
+	if (mA != 0.0f)
+	{
+		m_velocity[iA] = vA;
+		m_angularVelocity[iA] = wA;
+	}
+	if (mB != 0.0f)
+	{
+		m_velocity[iB] = vB;
+		m_angularVelocity[iB] = wB;
+	}
+}
+
+// Drives the separating velocity of points that were hit fast enough to the
+// restitution target stored in c.bias by Initialize()
+void KContactSolver::_RestituteManifold(uint32 i)
+{
+	KContactConstraints& c = m_constraints;
+	const uint32 iA = c.indexA[i];
+	const uint32 iB = c.indexB[i];
+	const float mA = m_invMass[iA], mB = m_invMass[iB];
+	const float invIA = m_invI[iA], invIB = m_invI[iB];
+	const KVector2 n = c.normal[i];
+
+	KVector2 vA = m_velocity[iA];
+	KVector2 vB = m_velocity[iB];
+	float wA = m_angularVelocity[iA];
+	float wB = m_angularVelocity[iB];
+
+	for (uint32 j = 0; j < c.pointCount[i]; ++j)
+	{
+		const uint32 p = 2 * i + j;
+		if (c.bias[p] <= 0.0f || c.maxNormalImpulse[p] == 0.0f)
+			continue;
+
+		const KVector2 ra = c.ra[p];
+		const KVector2 rb = c.rb[p];
+		const KVector2 dv = vB + KVector2::Cross(wB, rb) - vA - KVector2::Cross(wA, ra);
+		const float vn = KVector2::Dot(dv, n);
+		float lambda = -c.normalMass[p] * (vn - c.bias[p]);
+		const float oldImpulse = c.normalImpulse[p];
+		c.normalImpulse[p] = __max(oldImpulse + lambda, 0.0f);
+		lambda = c.normalImpulse[p] - oldImpulse;
+
+		const KVector2 P = lambda * n;
+		vA -= mA * P;
+		wA -= invIA * KVector2::Cross(ra, P);
+		vB += mB * P;
+		wB += invIB * KVector2::Cross(rb, P);
+	}
+
+	if (mA != 0.0f)
+	{
+		m_velocity[iA] = vA;
+		m_angularVelocity[iA] = wA;
+	}
+	if (mB != 0.0f)
+	{
+		m_velocity[iB] = vB;
+		m_angularVelocity[iB] = wB;
+	}
+}
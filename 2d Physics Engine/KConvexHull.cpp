@@ -0,0 +1,106 @@
+#include "KConvexHull.h"
+#include "KThreadPool.h"
+#include <algorithm>
+#include <cstdlib> // __min
+
+namespace
+{
+	bool _IsLess(const KVector2& a, const KVector2& b)
+	{
+		return a.x < b.x || (a.x == b.x && a.y < b.y);
+	}
+
+	// Builds the hull of points sorted by _IsLess() into hull (2 * count points)
+	uint32 _Build(const KVector2* sorted, uint32 count, KVector2* hull)
+	{
+		if (count < 3)
+			return 0;
+
+		// Lower hull, then upper hull. Anything but a left turn is popped,
+		// which also removes collinear points.
+		uint32 k = 0;
+		for (uint32 i = 0; i < count; ++i)
+		{
+			while (k >= 2 && KVector2::GetDirection(hull[k - 2], hull[k - 1], sorted[i]) != 2)
+				--k;
+			hull[k++] = sorted[i];
+		}
+		const uint32 lower = k + 1;
+		for (uint32 i = count - 1; i > 0; --i)
+		{
+			while (k >= lower && KVector2::GetDirection(hull[k - 2], hull[k - 1], sorted[i - 1]) != 2)
+				--k;
+			hull[k++] = sorted[i - 1];
+		}
+		--k; // the first point closes the upper hull
+
+		if (k < 3)
+			return 0;
+
+		// Start at the lowest point
+		uint32 first = 0;
+		for (uint32 i = 1; i < k; ++i)
+		{
+			if (hull[i].y < hull[first].y || (hull[i].y == hull[first].y && hull[i].x < hull[first].x))
+				first = i;
+		}
+		std::rotate(hull, hull + first, hull + k);
+		return k;
+	}
+}
+
+uint32 KConvexHull::Compute(const KVector2* points, uint32 count, KVector2* hull, KVector2* scratch)
+{
+	std::copy(points, points + count, scratch);
+	std::sort(scratch, scratch + count, _IsLess);
+	return _Build(scratch, count, hull);
+}
+
+uint32 KConvexHull::ComputeParallel(const KVector2* points, uint32 count, KVector2* hull, KVector2* scratch,
+	KThreadPool& threadPool)
+{
+	const uint32 k_minChunk = 1024;
+	const uint32 k_maxChunks = 64;
+	const uint32 threadChunks = threadPool.GetThreadCount() * 4;
+	const uint32 numChunks = __min(__min(threadChunks, count / k_minChunk), k_maxChunks);
+	if (numChunks <= 1)
+		return Compute(points, count, hull, scratch);
+
+	// Chunk c hulls points [begin, end) through scratch[begin, end) into hull[2 * begin, 2 * end)
+	const uint32 chunkSize = (count + numChunks - 1) / numChunks;
+	uint32 chunkHullCount[k_maxChunks];
+	threadPool.ParallelFor(numChunks, 1, [&](uint32 first, uint32 last)
+	{
+		for (uint32 c = first; c < last; ++c)
+		{
+			const uint32 begin = __min(c * chunkSize, count);
+			const uint32 end = __min(begin + chunkSize, count);
+			chunkHullCount[c] = Compute(points + begin, end - begin, hull + 2 * begin, scratch + begin);
+		}
+	});
+
+	// Every point of the hull is on the hull of its chunk. A chunk without a
+	// hull is collinear, only its end points (sorted into scratch) may count.
+	// Chunks never grow, so the compacted points stay behind the chunk read.
+	uint32 total = 0;
+	for (uint32 c = 0; c < numChunks; ++c)
+	{
+		const uint32 begin = __min(c * chunkSize, count);
+		const uint32 end = __min(begin + chunkSize, count);
+		if (chunkHullCount[c] > 0)
+		{
+			std::copy(hull + 2 * begin, hull + 2 * begin + chunkHullCount[c], scratch + total);
+			total += chunkHullCount[c];
+		}
+		else if (begin < end)
+		{
+			const KVector2 first = scratch[begin];
+			const KVector2 last = scratch[end - 1];
+			scratch[total++] = first;
+			scratch[total++] = last;
+		}
+	}
+
+	std::sort(scratch, scratch + total, _IsLess);
+	return _Build(scratch, total, hull);
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "KMath.h"
+#include "KVector2.h"
+
+class KThreadPool;
+
+// Andrew's monotone chain. Reentrant and allocation free: the input is never
+// modified and all work happens in buffers owned by the caller.
+//
+// The hull is written counter-clockwise starting at the lowest (then leftmost)
+// point; collinear points are dropped. Fewer than three non-collinear points
+// give an empty hull.
+namespace KConvexHull
+{
+	// hull must hold 2 * count points, scratch count points.
+	// Returns the number of hull vertices.
+	uint32 Compute(const KVector2* points, uint32 count, KVector2* hull, KVector2* scratch);
+	// Same result for large inputs: chunks of the input are hulled in parallel
+	// and the chunk hulls merged with one more pass. Same buffer sizes.
+	uint32 ComputeParallel(const KVector2* points, uint32 count, KVector2* hull, KVector2* scratch,
+		KThreadPool& threadPool);
+}
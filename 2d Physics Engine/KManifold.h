@@ -30,21 +30,15 @@ struct KManifold// : public std::enable_shared_from_this<KManifold>
 {
 	KManifold(std::shared_ptr<KRigidbody> rigidA, std::shared_ptr<KRigidbody> rigidB);
 	void Solve();                 // Generate contact information
-	void Initialize();            // Precalculations for impulse solving
-	void ApplyImpulse();          // Solve impulse and apply
-	void PositionalCorrection();  // Naive correction of positional penetration
-	void InfiniteMassCorrection();
 
 	std::shared_ptr<KRigidbody> rigidbodyA;
 	std::shared_ptr<KRigidbody> rigidbodyB;
 
 	float penetration;     // Depth of penetration from collision
+	float depths[2];          // Depth of penetration of each contact
 	KVector2 normal;          // From A to B
 	KVector2 contacts[2];     // Points of contact during collision
 	uint32 contact_count;	// Number of contacts that occurred during collision
-	float restitution;		// Mixed restitution
-	float df;              // Mixed dynamic friction
-	float sf;              // Mixed static friction
 };
 
 #endif // MANIFOLD_H
\ No newline at end of file
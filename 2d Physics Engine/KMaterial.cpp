@@ -0,0 +1,44 @@
+#include "KMaterial.h"
+#include <cstdlib> // __min
+
+KMaterialTable::KMaterialTable()
+{
+	KMaterial material;
+	material.staticFriction = 0.4f;
+	material.dynamicFriction = 0.2f;
+	material.restitution = 0.2f;
+	Add(material); // k_default
+}
+
+KMaterialId KMaterialTable::Add(const KMaterial& material)
+{
+	assert(m_count < k_maxMaterials);
+	if (m_count == k_maxMaterials)
+		return k_default;
+
+	const KMaterialId id = m_count++;
+	Set(id, material);
+	return id;
+}
+
+void KMaterialTable::Set(KMaterialId id, const KMaterial& material)
+{
+	assert(id < m_count);
+	m_materials[id] = material;
+	_MixPairs(id);
+}
+
+void KMaterialTable::_MixPairs(KMaterialId id)
+{
+	const KMaterial& a = m_materials[id];
+	for (uint32 i = 0; i < m_count; ++i)
+	{
+		const KMaterial& b = m_materials[i];
+		KMaterialPair pair;
+		pair.staticFriction = std::sqrt(a.staticFriction * b.staticFriction);
+		pair.dynamicFriction = std::sqrt(a.dynamicFriction * b.dynamicFriction);
+		pair.restitution = __min(a.restitution, b.restitution);
+		m_pairs[id * k_maxMaterials + i] = pair;
+		m_pairs[i * k_maxMaterials + id] = pair;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cassert>
+#include "KMath.h"
+
+// Surface properties of a rigidbody
+struct KMaterial
+{
+	float staticFriction;
+	float dynamicFriction;
+	float restitution;
+};
+
+// Coefficients of two materials in contact, already mixed
+struct KMaterialPair
+{
+	float staticFriction;	// sqrt(a * b)
+	float dynamicFriction;	// sqrt(a * b)
+	float restitution;		// min(a, b)
+};
+
+typedef uint32 KMaterialId;
+
+// Fixed set of materials. The mixed coefficients of every pair are computed
+// when a material is added or changed, so contact setup only does a lookup.
+class KMaterialTable
+{
+public:
+	static const uint32			k_maxMaterials = 32;
+	static const KMaterialId	k_default = 0;
+
+	KMaterialTable();
+
+	KMaterialId Add(const KMaterial& material);
+	void Set(KMaterialId id, const KMaterial& material);
+	const KMaterial& Get(KMaterialId id) const { assert(id < m_count); return m_materials[id]; }
+	const KMaterialPair& GetPair(KMaterialId a, KMaterialId b) const { return m_pairs[a * k_maxMaterials + b]; }
+	uint32 GetCount() const { return m_count; }
+
+private:
+	void _MixPairs(KMaterialId id);
+
+private:
+	KMaterial		m_materials[k_maxMaterials];
+	uint32			m_count = 0;
+	KMaterialPair	m_pairs[k_maxMaterials * k_maxMaterials];
+};
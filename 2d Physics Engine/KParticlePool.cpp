@@ -0,0 +1,53 @@
+#include "KParticlePool.h"
+
+void KParticlePool::Initialize(uint32 capacity)
+{
+	position.resize(capacity);
+	velocity.resize(capacity);
+	acceleration.resize(capacity);
+	age.resize(capacity);
+	lifetime.resize(capacity);
+	color.resize(capacity);
+	m_count = 0;
+}
+
+bool KParticlePool::Add(const KVector2& position_, const KVector2& velocity_, const KVector2& acceleration_,
+	COLORREF color_, float lifetime_)
+{
+	if (m_count == GetCapacity())
+		return false;
+
+	const uint32 i = m_count++;
+	position[i] = position_;
+	velocity[i] = velocity_;
+	acceleration[i] = acceleration_;
+	age[i] = 0.0f;
+	lifetime[i] = lifetime_;
+	color[i] = color_;
+	return true;
+}
+
+void KParticlePool::Update(float fElapsedTime)
+{
+	uint32 i = 0;
+	while (i < m_count)
+	{
+		velocity[i] += acceleration[i] * fElapsedTime;
+		position[i] += velocity[i] * fElapsedTime;
+		age[i] += fElapsedTime;
+		if (age[i] <= lifetime[i])
+		{
+			++i;
+			continue;
+		}
+
+		// Swap and pop, the moved particle is updated next
+		const uint32 last = --m_count;
+		position[i] = position[last];
+		velocity[i] = velocity[last];
+		acceleration[i] = acceleration[last];
+		age[i] = age[last];
+		lifetime[i] = lifetime[last];
+		color[i] = color[last];
+	}
+}
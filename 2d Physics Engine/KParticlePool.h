@@ -0,0 +1,34 @@
+#pragma once
+#include <Windows.h>
+#include <vector>
+#include "KMath.h"
+#include "KVector2.h"
+
+// Fixed-capacity particle store as structure-of-arrays. The live particles
+// are kept dense in [0, GetCount()): Update() ages and moves them in one
+// pass and swap-removes the expired ones in place, so nothing is allocated
+// after Initialize().
+class KParticlePool
+{
+public:
+	void Initialize(uint32 capacity);
+	// Returns false when the pool is full
+	bool Add(const KVector2& position, const KVector2& velocity, const KVector2& acceleration, COLORREF color,
+		float lifetime);
+	void Update(float fElapsedTime);
+	void Clear() { m_count = 0; }
+
+	uint32 GetCount() const { return m_count; }
+	uint32 GetCapacity() const { return (uint32)position.size(); }
+
+	// [0, GetCount()) is live
+	std::vector<KVector2>	position;
+	std::vector<KVector2>	velocity;
+	std::vector<KVector2>	acceleration;	// e.g. gravity and wind
+	std::vector<float>		age;
+	std::vector<float>		lifetime;
+	std::vector<COLORREF>	color;
+
+private:
+	uint32					m_count = 0;
+};
@@ -0,0 +1,59 @@
+#include "KParticleRing.h"
+#include <cassert>
+#include <cstdlib> // __min
+
+void KParticleRing::Initialize(uint32 capacity, float lifetime)
+{
+	assert(capacity > 0);
+	uint32 size = 1;
+	while (size < capacity)
+		size <<= 1;
+
+	position.resize(size);
+	velocity.resize(size);
+	age.resize(size);
+	m_mask = size - 1;
+	m_lifetime = lifetime;
+	Clear();
+}
+
+void KParticleRing::Add(const KVector2& position_, const KVector2& velocity_)
+{
+	// Full, the oldest particle makes room
+	if (m_count == GetCapacity())
+	{
+		m_tail = (m_tail + 1) & m_mask;
+		--m_count;
+	}
+
+	const uint32 i = (m_tail + m_count++) & m_mask;
+	position[i] = position_;
+	velocity[i] = velocity_;
+	age[i] = 0.0f;
+}
+
+void KParticleRing::Update(float fElapsedTime, const KVector2& acceleration)
+{
+	// The live particles are at most two runs: from the tail to the end of
+	// the arrays, then from the start
+	const KVector2 dv = acceleration * fElapsedTime;
+	const uint32 toEnd = GetCapacity() - m_tail;
+	const uint32 first = __min(m_count, toEnd);
+	const uint32 runs[2][2] = { { m_tail, m_tail + first }, { 0, m_count - first } };
+	for (const uint32* run : runs)
+	{
+		for (uint32 i = run[0]; i < run[1]; ++i)
+		{
+			velocity[i] += dv;
+			position[i] += velocity[i] * fElapsedTime;
+			age[i] += fElapsedTime;
+		}
+	}
+
+	// Oldest first, so expiry stops at the first particle still alive
+	while (m_count > 0 && age[m_tail] > m_lifetime)
+	{
+		m_tail = (m_tail + 1) & m_mask;
+		--m_count;
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include "KMath.h"
+#include "KVector2.h"
+
+// Particles that all live for the same time, as structure-of-arrays in a
+// ring buffer. They expire in the order they were added, so Add() writes at
+// the head and Update() only advances the tail past the expired ones:
+// nothing is compacted and no particle is tested but the oldest. A full ring
+// overwrites its oldest particle.
+class KParticleRing
+{
+public:
+	// capacity is rounded up to a power of two
+	void Initialize(uint32 capacity, float lifetime);
+	void Add(const KVector2& position, const KVector2& velocity);
+	// acceleration applies to every particle, e.g. gravity and wind
+	void Update(float fElapsedTime, const KVector2& acceleration);
+	void Clear() { m_tail = 0; m_count = 0; }
+
+	uint32 GetCount() const { return m_count; }
+	uint32 GetCapacity() const { return (uint32)position.size(); }
+	float GetLifetime() const { return m_lifetime; }
+	// Array index of the i-th oldest live particle, i in [0, GetCount())
+	uint32 GetIndex(uint32 i) const { return (m_tail + i) & m_mask; }
+
+	// indexed by GetIndex()
+	std::vector<KVector2>	position;
+	std::vector<KVector2>	velocity;
+	std::vector<float>		age;
+
+private:
+	uint32					m_mask = 0;		// capacity - 1
+	uint32					m_tail = 0;		// oldest particle
+	uint32					m_count = 0;
+	float					m_lifetime = 0.0f;
+};
@@ -1 +0,0 @@
-#include "KParticleSystemData.h"
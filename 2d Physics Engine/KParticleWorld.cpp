@@ -0,0 +1,207 @@
+#include "KParticleWorld.h"
+#include "KVectorUtil.h"
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	// Start position and velocity of a new particle
+	void _Sample(const KEmitterDesc& desc, const KVector2& emitterPosition, KVector2& position, KVector2& velocity)
+	{
+		const KVector2 offset(Random(-desc.spread, desc.spread), Random(-desc.spread, desc.spread));
+		const float angle = Random(0.0f, 2.0f * PI);
+		const float speed = Random(desc.minSpeed, desc.maxSpeed);
+		position = emitterPosition + offset;
+		velocity.Set(speed * std::cos(angle), speed * std::sin(angle));
+	}
+
+	void _Spawn(KParticlePool& particles, const KEmitterDesc& desc, const KVector2& emitterPosition, uint32 count)
+	{
+		KVector2 position, velocity;
+		for (uint32 i = 0; i < count; ++i)
+		{
+			_Sample(desc, emitterPosition, position, velocity);
+			if (!particles.Add(position, velocity, desc.acceleration, desc.color,
+				Random(desc.minLifetime, desc.maxLifetime)))
+			{
+				return; // full
+			}
+		}
+	}
+
+	void _DrawParticle(HDC hdc, const KVector2& position, float age, float lifetime, COLORREF color)
+	{
+		// --- COORDINATE TRANSFORMATION ---
+		// Manually convert to screen space to bypass the heavier KVectorUtil::DrawLine logic.
+		KVector2 screenPos = KVectorUtil::WorldToScreen(position);
+
+		// --- LIFETIME VISUALS ---
+		// Simulate "fading out" by reducing size based on age ratio, as GDI alpha blending is expensive.
+		float ratio = age / lifetime;
+		int size = 2; // Base radius
+
+		if (ratio > 0.5f) size = 1; // Shrink
+		if (ratio > 0.8f) size = 0; // Disappear
+
+		if (size > 0)
+		{
+			SetDCBrushColor(hdc, color);
+
+			// Draw primitive (Rectangle is faster than Ellipse)
+			Rectangle(hdc,
+				(int)screenPos.x - size, (int)screenPos.y - size,
+				(int)screenPos.x + size, (int)screenPos.y + size);
+		}
+	}
+}
+
+void KParticleWorld::Initialize(uint32 capacity)
+{
+	m_particles.Initialize(capacity);
+	Clear();
+}
+
+void KParticleWorld::Clear()
+{
+	m_particles.Clear();
+	m_freeEmitters.clear();
+	for (uint32 i = 0; i < (uint32)m_emitters.size(); ++i)
+	{
+		Emitter& emitter = m_emitters[i];
+		if (emitter.isAlive)
+		{
+			emitter.isAlive = false;
+			++emitter.generation;
+		}
+		emitter.ring.Clear();
+		m_freeEmitters.push_back(i);
+	}
+}
+
+KEmitterHandle KParticleWorld::CreateEmitter(const KEmitterDesc& desc, const KVector2& position)
+{
+	uint32 slot;
+	if (m_freeEmitters.empty())
+	{
+		slot = (uint32)m_emitters.size();
+		m_emitters.push_back(Emitter());
+	}
+	else
+	{
+		slot = m_freeEmitters.back();
+		m_freeEmitters.pop_back();
+	}
+
+	Emitter& emitter = m_emitters[slot];
+	emitter.desc = desc;
+	emitter.position = position;
+	emitter.pending = 0.0f;
+	emitter.isAlive = true;
+	if (desc.ringCapacity > 0)
+	{
+		assert(desc.minLifetime == desc.maxLifetime);
+		emitter.ring.Initialize(desc.ringCapacity, desc.maxLifetime);
+	}
+
+	KEmitterHandle handle;
+	handle.index = slot;
+	handle.generation = emitter.generation;
+	return handle;
+}
+
+void KParticleWorld::DestroyEmitter(KEmitterHandle handle)
+{
+	assert(IsValid(handle));
+	if (!IsValid(handle))
+		return;
+
+	Emitter& emitter = m_emitters[handle.index];
+	emitter.isAlive = false;
+	++emitter.generation;
+	// Particles outlive the emitter, Update() frees the slot once the ring drains
+	if (emitter.desc.ringCapacity == 0 || emitter.ring.GetCount() == 0)
+		m_freeEmitters.push_back(handle.index);
+}
+
+void KParticleWorld::SetPosition(KEmitterHandle handle, const KVector2& position)
+{
+	assert(IsValid(handle));
+	m_emitters[handle.index].position = position;
+}
+
+void KParticleWorld::Emit(KEmitterHandle handle, uint32 count)
+{
+	assert(IsValid(handle));
+	_Emit(m_emitters[handle.index], count);
+}
+
+void KParticleWorld::Burst(const KEmitterDesc& desc, const KVector2& position, uint32 count)
+{
+	_Spawn(m_particles, desc, position, count);
+}
+
+void KParticleWorld::Update(float fElapsedTime)
+{
+	for (uint32 i = 0; i < (uint32)m_emitters.size(); ++i)
+	{
+		Emitter& emitter = m_emitters[i];
+		if (emitter.isAlive && emitter.desc.rate > 0.0f)
+		{
+			emitter.pending += emitter.desc.rate * fElapsedTime;
+			const uint32 count = (uint32)emitter.pending;
+			emitter.pending -= (float)count;
+			_Emit(emitter, count);
+		}
+
+		if (emitter.ring.GetCount() > 0)
+		{
+			emitter.ring.Update(fElapsedTime, emitter.desc.acceleration);
+			if (!emitter.isAlive && emitter.ring.GetCount() == 0)
+				m_freeEmitters.push_back(i);
+		}
+	}
+
+	m_particles.Update(fElapsedTime);
+}
+
+void KParticleWorld::_Emit(Emitter& emitter, uint32 count)
+{
+	if (emitter.desc.ringCapacity == 0)
+	{
+		_Spawn(m_particles, emitter.desc, emitter.position, count);
+		return;
+	}
+
+	KVector2 position, velocity;
+	for (uint32 i = 0; i < count; ++i)
+	{
+		_Sample(emitter.desc, emitter.position, position, velocity);
+		emitter.ring.Add(position, velocity);
+	}
+}
+
+void KParticleWorld::Draw(HDC hdc) const
+{
+	// --- GDI BATCH SETUP ---
+	// Use NULL_PEN (no border) and DC_BRUSH (solid fill) to minimize object creation overhead.
+	// This allows to just change the DC brush color per particle.
+	HGDIOBJ oldPen = SelectObject(hdc, GetStockObject(NULL_PEN));
+	HGDIOBJ oldBrush = SelectObject(hdc, GetStockObject(DC_BRUSH));
+
+	for (uint32 i = 0; i < m_particles.GetCount(); i++)
+		_DrawParticle(hdc, m_particles.position[i], m_particles.age[i], m_particles.lifetime[i], m_particles.color[i]);
+
+	for (const Emitter& emitter : m_emitters)
+	{
+		const KParticleRing& ring = emitter.ring;
+		for (uint32 k = 0; k < ring.GetCount(); ++k)
+		{
+			const uint32 i = ring.GetIndex(k);
+			_DrawParticle(hdc, ring.position[i], ring.age[i], ring.GetLifetime(), emitter.desc.color);
+		}
+	}
+
+	// Restore previous GDI state
+	SelectObject(hdc, oldBrush);
+	SelectObject(hdc, oldPen);
+}
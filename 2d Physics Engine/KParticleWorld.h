@@ -0,0 +1,89 @@
+#pragma once
+#include <Windows.h>
+#include <vector>
+#include "KMath.h"
+#include "KVector2.h"
+#include "KParticlePool.h"
+#include "KParticleRing.h"
+
+// Names an emitter of a KParticleWorld. A handle goes stale when its emitter
+// is destroyed, even if the slot is reused by a later emitter.
+struct KEmitterHandle
+{
+	uint32 index = 0xffffffff;	// slot
+	uint32 generation = 0;
+
+	bool operator==(const KEmitterHandle& rhs) const { return index == rhs.index && generation == rhs.generation; }
+	bool operator!=(const KEmitterHandle& rhs) const { return !(*this == rhs); }
+};
+
+// What an emitter spawns. Every particle gets a random offset, direction,
+// speed and lifetime within the ranges.
+struct KEmitterDesc
+{
+	KVector2	acceleration;				// e.g. gravity and wind
+	float		spread = 0.0f;				// largest offset from the emitter on each axis
+	float		minSpeed = 0.0f;			// in a random direction
+	float		maxSpeed = 0.0f;
+	float		minLifetime = 1.0f;			// seconds
+	float		maxLifetime = 1.0f;
+	COLORREF	color = RGB(0, 0, 0);
+	float		rate = 0.0f;				// particles per second spawned by Update(), 0 for none
+	uint32		ringCapacity = 0;			// > 0 keeps the particles in a KParticleRing of their own,
+											// needs minLifetime == maxLifetime
+};
+
+// Owns every particle in one KParticlePool, so Update() and Draw() are a
+// single pass over the arrays however many effects are running. An emitter
+// is only a description and a position: a trail moves its emitter and
+// Emit()s a few particles per frame, a fountain sets a rate, and one-off
+// effects Burst() a description without any emitter. Particles outlive the
+// emitter that spawned them; spawning into a full world drops the particle.
+//
+// Particles of one fixed lifetime expire in spawn order, so such an emitter
+// may keep them in a ring instead (KEmitterDesc::ringCapacity): a trail, or
+// a fixed-lifetime burst by moving the emitter and Emit()ting. A full ring
+// drops its oldest particle instead of the new one.
+class KParticleWorld
+{
+public:
+	void Initialize(uint32 capacity);
+	// Removes all particles and emitters, invalidates all handles
+	void Clear();
+
+	KEmitterHandle CreateEmitter(const KEmitterDesc& desc, const KVector2& position);
+	void DestroyEmitter(KEmitterHandle handle);
+	bool IsValid(KEmitterHandle handle) const
+	{
+		return handle.index < (uint32)m_emitters.size() && m_emitters[handle.index].generation == handle.generation
+			&& m_emitters[handle.index].isAlive;
+	}
+	void SetPosition(KEmitterHandle handle, const KVector2& position);
+	// Spawns count particles at the emitter now
+	void Emit(KEmitterHandle handle, uint32 count);
+	// Spawns count particles at position without an emitter
+	void Burst(const KEmitterDesc& desc, const KVector2& position, uint32 count);
+
+	// Emitters with a rate spawn, then all particles move and age
+	void Update(float fElapsedTime);
+	void Draw(HDC hdc) const;
+
+	const KParticlePool& GetParticlePool() const { return m_particles; }
+
+private:
+	struct Emitter
+	{
+		KEmitterDesc	desc;
+		KVector2		position;
+		float			pending = 0.0f;		// fraction of a particle the rate still owes
+		uint32			generation = 0;
+		bool			isAlive = false;	// a destroyed emitter's slot is reused once its ring is empty
+		KParticleRing	ring;				// when desc.ringCapacity > 0
+	};
+
+	void _Emit(Emitter& emitter, uint32 count);
+
+	KParticlePool			m_particles;
+	std::vector<Emitter>	m_emitters;
+	std::vector<uint32>		m_freeEmitters;
+};
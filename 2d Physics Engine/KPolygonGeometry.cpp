@@ -0,0 +1,264 @@
+#include "KPolygonGeometry.h"
+#include "KConvexHull.h"
+#include <cassert>
+#include <vector>
+
+/*static*/ KPolygonGeometryPtr KPolygonGeometry::Create(const KVector2* points, uint32 count)
+{
+	std::shared_ptr<KPolygonGeometry> geometry = std::make_shared<KPolygonGeometry>();
+	geometry->Build(points, count);
+	return geometry;
+}
+
+/*static*/ KPolygonGeometryPtr KPolygonGeometry::CreateBox(float halfWidth, float halfHeight)
+{
+	std::shared_ptr<KPolygonGeometry> geometry = std::make_shared<KPolygonGeometry>();
+	geometry->BuildBox(halfWidth, halfHeight);
+	return geometry;
+}
+
+void KPolygonGeometry::Build(const KVector2* points, uint32 count)
+{
+	// Small inputs are hulled on the stack
+	const uint32 k_stackPoints = 64;
+	KVector2 stackBuffer[3 * k_stackPoints];
+	std::vector<KVector2> heapBuffer;
+	KVector2* hull = stackBuffer;
+	if (count > k_stackPoints)
+	{
+		heapBuffer.resize(3 * count);
+		hull = &heapBuffer[0];
+	}
+	const uint32 hullCount = KConvexHull::Compute(points, count, hull, hull + 2 * count);
+	vertexCount = _Simplify(hull, hullCount, k_maxVertices);
+	for (uint32 i = 0; i < vertexCount; ++i)
+		vertices[i] = hull[i];
+
+	const int n = vertexCount;
+
+	// Compute face normals
+	for (int i1 = 0; i1 < n; ++i1)
+	{
+		int i2 = i1 + 1 < n ? i1 + 1 : 0;
+		KVector2 face = vertices[i2] - vertices[i1];
+
+		// Ensure no zero-length edges, because that's bad
+		assert(face.LengthSquared() > EPSILON * EPSILON);
+
+		// Calculate normal with 2D cross product between vector and scalar
+		normals[i1] = KVector2(face.y, -face.x);
+		normals[i1].Normalize();
+	}
+
+	_ComputeMassProperties();
+}
+
+void KPolygonGeometry::BuildBox(float hw, float hh)
+{
+	vertexCount = 4;
+	vertices[0].Set(-hw, -hh);
+	vertices[1].Set(hw, -hh);
+	vertices[2].Set(hw, hh);
+	vertices[3].Set(-hw, hh);
+	normals[0].Set(0.0f, -1.0f);
+	normals[1].Set(1.0f, 0.0f);
+	normals[2].Set(0.0f, 1.0f);
+	normals[3].Set(-1.0f, 0.0f);
+
+	_ComputeMassProperties();
+}
+
+bool KPolygonGeometry::Split(const KVector2& p0, const KVector2& p1, KPolygonGeometry& front, KPolygonGeometry& back) const
+{
+	// A half has at most one vertex more than the polygon
+	struct Half
+	{
+		KVector2	vertices[k_maxVertices + 1];
+		KVector2	normals[k_maxVertices + 1];		// of the edge ending at each vertex
+		uint32		count = 0;
+		float		area = 0.0f;
+		KVector2	centroid;
+		float		inertia = 0.0f;
+
+		// A cut through (almost) a vertex would add a degenerate edge: the
+		// point is dropped, its edge was the degenerate one
+		void Add(const KVector2& v, const KVector2& n)
+		{
+			if (count > 0 && KVector2::DistSquared(vertices[count - 1], v) <= EPSILON * EPSILON)
+				return;
+			if (count > 0)
+				_AddTriangle(vertices[count - 1], v, area, centroid, inertia);
+			vertices[count] = v;
+			normals[count] = n;
+			++count;
+		}
+	};
+	Half halves[2];
+	Half& f = halves[0];
+	Half& b = halves[1];
+
+	// The cut edge faces the other half
+	const KVector2 r = p1 - p0;
+	KVector2 cutNormal(-r.y, r.x);
+	cutNormal.Normalize();
+
+	// Signed distances as in KVectorUtil::SplitConvex(). An edge keeps the
+	// parent's normal unless it runs along the cut.
+	uint32 i = vertexCount - 1;
+	float di = KVector2::Cross(r, vertices[i] - p0);
+	for (uint32 k = 0; k < vertexCount; ++k)
+	{
+		const KVector2& vi = vertices[i];
+		const KVector2& vk = vertices[k];
+		const float dk = KVector2::Cross(r, vk - p0);
+
+		if ((di < 0.0f && dk > 0.0f) || (di > 0.0f && dk < 0.0f))
+		{
+			// The edge leaves one half and enters the other across the cut
+			const KVector2 x = vi + (di / (di - dk)) * (vk - vi);
+			f.Add(x, di < 0.0f ? normals[i] : cutNormal);
+			b.Add(x, di > 0.0f ? normals[i] : -cutNormal);
+		}
+
+		// A vertex on the line reached from the other half closes the cut
+		if (dk <= 0.0f)
+			f.Add(vk, di > 0.0f && dk == 0.0f ? cutNormal : normals[i]);
+		if (dk >= 0.0f)
+			b.Add(vk, di < 0.0f && dk == 0.0f ? -cutNormal : normals[i]);
+
+		i = k;
+		di = dk;
+	}
+
+	// Close both loops, the last point may coincide with the first one
+	for (Half& half : halves)
+	{
+		if (half.count == 0)
+			continue;
+		if (half.count > 1 && KVector2::DistSquared(half.vertices[half.count - 1], half.vertices[0]) <= EPSILON * EPSILON)
+		{
+			half.normals[0] = half.normals[half.count - 1];
+			--half.count;
+		}
+		else
+		{
+			_AddTriangle(half.vertices[half.count - 1], half.vertices[0], half.area, half.centroid, half.inertia);
+		}
+	}
+
+	if (f.count < 3 || b.count < 3)
+		return false;
+
+	KPolygonGeometry* outputs[2] = { &front, &back };
+	for (uint32 h = 0; h < 2; ++h)
+	{
+		Half& half = halves[h];
+		KPolygonGeometry& output = *outputs[h];
+
+		// Too many vertices for a shape, take the slow path
+		if (half.count > k_maxVertices)
+		{
+			output.Build(half.vertices, half.count);
+			continue;
+		}
+
+		// Store each edge's normal at its start vertex
+		output.vertexCount = half.count;
+		for (uint32 v = 0; v < half.count; ++v)
+		{
+			output.vertices[v] = half.vertices[v];
+			output.normals[v] = half.normals[v + 1 < half.count ? v + 1 : 0];
+		}
+		output._SetMassProperties(half.area, half.centroid, half.inertia);
+	}
+	return true;
+}
+
+void KPolygonGeometry::_ComputeMassProperties()
+{
+	// Calculate centroid and moment of inertia
+	KVector2 c(0.0f, 0.0f); // centroid
+	float totalArea = 0.0f;
+	float I = 0.0f;
+
+	for (uint32 i1 = 0; i1 < vertexCount; ++i1)
+	{
+		// Triangle vertices, third vertex implied as (0, 0)
+		uint32 i2 = i1 + 1 < vertexCount ? i1 + 1 : 0;
+		_AddTriangle(vertices[i1], vertices[i2], totalArea, c, I);
+	}
+
+	_SetMassProperties(totalArea, c, I);
+}
+
+/*static*/ void KPolygonGeometry::_AddTriangle(const KVector2& p1, const KVector2& p2, float& area,
+	KVector2& centroid, float& inertia)
+{
+	const float k_inv3 = 1.0f / 3.0f;
+
+	float D = KVector2::Cross(p1, p2);
+	float triangleArea = 0.5f * D;
+
+	area += triangleArea;
+
+	// Use area to weight the centroid average, not just vertex position
+	centroid += triangleArea * k_inv3 * (p1 + p2);
+
+	float intx2 = p1.x * p1.x + p2.x * p1.x + p2.x * p2.x;
+	float inty2 = p1.y * p1.y + p2.y * p1.y + p2.y * p2.y;
+	inertia += (0.25f * k_inv3 * D) * (intx2 + inty2);
+}
+
+void KPolygonGeometry::_SetMassProperties(float totalArea, KVector2 c, float I)
+{
+	c *= 1.0f / totalArea;
+
+	// Translate vertices to centroid (make the centroid (0, 0)
+	// for the polygon in model space)
+	for (uint32 i = 0; i < vertexCount; ++i)
+		vertices[i] -= c;
+
+	area = totalArea;
+	centroid = c;
+	// Parallel axis theorem, the sums are about the old origin
+	inertia = I - totalArea * KVector2::Dot(c, c);
+}
+
+void KPolygonGeometry::Simplify(uint32 maxVertices)
+{
+	assert(maxVertices >= 3);
+	if (vertexCount <= maxVertices)
+		return;
+
+	KVector2 points[k_maxVertices];
+	for (uint32 i = 0; i < vertexCount; ++i)
+		points[i] = vertices[i] + centroid;
+	Build(points, _Simplify(points, vertexCount, maxVertices));
+}
+
+/*static*/ uint32 KPolygonGeometry::_Simplify(KVector2* points, uint32 count, uint32 maxVertices)
+{
+	while (count > maxVertices)
+	{
+		// The triangle a vertex forms with its neighbours is the area
+		// removing it cuts off the hull
+		uint32 best = 0;
+		float bestArea = FLT_MAX;
+		for (uint32 i = 0; i < count; ++i)
+		{
+			const KVector2& prev = points[i == 0 ? count - 1 : i - 1];
+			const KVector2& next = points[i + 1 == count ? 0 : i + 1];
+			const float triangleArea = std::abs(KVector2::Cross(points[i] - prev, next - prev));
+			if (triangleArea < bestArea)
+			{
+				bestArea = triangleArea;
+				best = i;
+			}
+		}
+
+		for (uint32 i = best; i + 1 < count; ++i)
+			points[i] = points[i + 1];
+		--count;
+	}
+	return count;
+}
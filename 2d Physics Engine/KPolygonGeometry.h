@@ -0,0 +1,56 @@
+#pragma once
+#include <memory>
+#include "KMath.h"
+#include "KVector2.h"
+
+struct KPolygonGeometry;
+typedef std::shared_ptr<const KPolygonGeometry>	KPolygonGeometryPtr;
+
+// Convex polygon in model space with everything derived from it computed
+// once: face normals, area, centroid and moment of inertia. A geometry is
+// immutable once built, so any number of KPolygonShapes may share one, e.g.
+// all fruit spawned from the same prototype.
+//
+// Build() keeps at most k_maxVertices hull vertices: a larger hull is
+// simplified by repeatedly dropping the vertex whose removal loses the least
+// area, so the polygon stays convex and close to the input.
+struct KPolygonGeometry
+{
+	static const uint32 k_maxVertices = 16;
+
+	// The convex hull of the points, see KConvexHull
+	static KPolygonGeometryPtr Create(const KVector2* points, uint32 count);
+	// Half width and half height
+	static KPolygonGeometryPtr CreateBox(float halfWidth, float halfHeight);
+
+	// Fill a geometry allocated elsewhere, e.g. from a pool, before sharing it
+	void Build(const KVector2* points, uint32 count);
+	void BuildBox(float halfWidth, float halfHeight);
+	// Splits the polygon along the line through p0 and p1 in one pass without
+	// hulling again: the halves get their vertices, normals and mass
+	// properties straight from the pass, in this polygon's model space
+	// (centroid is where each half's vertices were moved from). front is
+	// the side KVectorUtil::ClipConvex() keeps. Returns false unless the line
+	// cuts the polygon in two.
+	bool Split(const KVector2& p0, const KVector2& p1, KPolygonGeometry& front, KPolygonGeometry& back) const;
+	// Drops the vertices that lose the least area until at most maxVertices
+	// (3 or more) remain, centroid stays relative to the original input
+	void Simplify(uint32 maxVertices);
+
+	uint32		vertexCount = 0;
+	KVector2	vertices[k_maxVertices];	// counter-clockwise, centroid at the origin
+	KVector2	normals[k_maxVertices];		// outward normal of the face from vertex i to i + 1
+	float		area = 0.0f;
+	KVector2	centroid;					// of the input points, the vertices are moved by -centroid
+	float		inertia = 0.0f;				// moment of inertia about the centroid at unit density
+
+private:
+	// Area, centroid and inertia of the vertices, then moves the centroid to the origin
+	void _ComputeMassProperties();
+	// Adds the triangle (0, p1, p2) to the unnormalized area, centroid and inertia
+	static void _AddTriangle(const KVector2& p1, const KVector2& p2, float& area, KVector2& centroid, float& inertia);
+	// Normalizes the sums of _AddTriangle() and moves the centroid to the origin
+	void _SetMassProperties(float area, KVector2 centroid, float inertia);
+	// Drops vertices until at most maxVertices remain
+	static uint32 _Simplify(KVector2* vertices, uint32 count, uint32 maxVertices);
+};
@@ -2,12 +2,18 @@
 #define _KPOLYGONSHAPE_H_
 
 #include "KShape.h"
+#include "KPolygonGeometry.h"
 #include "KRigidbody.h"
 #include "KMath.h"
 #include "KVectorUtil.h"
 
+// Convex polygon over a KPolygonGeometry. The geometry is shared, not copied:
+// bodies spawned from one prototype all point at the same vertices, and
+// Set() or SetBox() give the shape a private geometry of its own.
 struct KPolygonShape : public KShape
 {
+	static const uint32 k_maxVertices = KPolygonGeometry::k_maxVertices;
+
 	void Initialize();
 	bool IsValid() const;
 	void ComputeMass(float density);
@@ -15,13 +21,20 @@ struct KPolygonShape : public KShape
 	KShape::Type GetType() const;
 	void ComputeAABB() override;
 	void SetBox(float halfWidth, float halfHeight);
-	void Set(KVector2* vertices, uint32 count);
-	void FindConvexHull(KVector2 points[], int n, std::vector<KVector2>& convexHullPoints);
+	// The polygon is the convex hull of the points, see KPolygonGeometry
+	void Set(const KVector2* vertices, uint32 count);
+	void SetGeometry(KPolygonGeometryPtr geometry);
+	const KPolygonGeometryPtr& GetGeometry() const { return m_geometry; }
 	// The extreme point along a direction within a polygon
 	KVector2 GetSupportPoint(const KVector2& dir);
 
-	std::vector<KVector2> m_vertices;
-	std::vector<KVector2> m_normals;
+	// Cached from m_geometry
+	uint32 m_vertexCount = 0;
+	const KVector2* m_vertices = nullptr;
+	const KVector2* m_normals = nullptr;
+
+private:
+	KPolygonGeometryPtr m_geometry;
 };
 
 #endif // _KPOLYGONSHAPE_H_
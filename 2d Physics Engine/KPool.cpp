@@ -0,0 +1,72 @@
+#include "KPool.h"
+#include <cassert>
+#include <cstdlib> // __max
+
+KBlockPool::State::~State()
+{
+	// Every pooled object held the state, only raw Allocate() can leak here
+	assert(m_stats.liveBlocks == 0);
+	for (void* slab : m_slabs)
+		::operator delete(slab);
+}
+
+void* KBlockPool::State::Allocate(size_t size)
+{
+	if (m_blockSize == 0)
+		m_blockSize = _GetBlockSize(size);
+
+	if (_GetBlockSize(size) != m_blockSize)
+	{
+		m_stats.heapAllocations++;
+		return ::operator new(size);
+	}
+
+	if (m_freeList == nullptr)
+		_AddSlab();
+
+	FreeBlock* block = m_freeList;
+	m_freeList = block->next;
+	m_stats.allocations++;
+	m_stats.liveBlocks++;
+	return block;
+}
+
+void KBlockPool::State::Free(void* p, size_t size)
+{
+	if (p == nullptr)
+		return;
+
+	if (_GetBlockSize(size) != m_blockSize)
+	{
+		::operator delete(p);
+		return;
+	}
+
+	assert(m_stats.liveBlocks > 0);
+	FreeBlock* block = static_cast<FreeBlock*>(p);
+	block->next = m_freeList;
+	m_freeList = block;
+	m_stats.liveBlocks--;
+}
+
+size_t KBlockPool::State::_GetBlockSize(size_t size)
+{
+	// Round up so that every block stays aligned like the slab
+	const size_t align = alignof(std::max_align_t);
+	return (__max(size, sizeof(FreeBlock)) + align - 1) / align * align;
+}
+
+void KBlockPool::State::_AddSlab()
+{
+	char* slab = static_cast<char*>(::operator new(m_blockSize * m_blocksPerSlab));
+	m_slabs.push_back(slab);
+	m_stats.slabs++;
+
+	// Thread the new blocks in address order
+	for (uint32 i = m_blocksPerSlab; i > 0; --i)
+	{
+		FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * m_blockSize);
+		block->next = m_freeList;
+		m_freeList = block;
+	}
+}
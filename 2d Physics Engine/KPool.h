@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+#include "KMath.h"
+
+// What a KBlockPool did so far
+struct KPoolStats
+{
+	uint32	allocations = 0;		// blocks handed out
+	uint32	liveBlocks = 0;			// blocks not freed yet
+	uint32	slabs = 0;				// slabs taken from the heap
+	uint32	heapAllocations = 0;	// requests that did not fit a block
+};
+
+// Free-list allocator for blocks of one size. Memory is taken from the heap
+// in slabs of m_blocksPerSlab blocks and reused after Free(). The block size
+// is fixed by the first Allocate(), requests of another size go to the heap.
+// Not thread safe.
+//
+// The free list and the slabs live in a State shared with every
+// KPoolAllocator made from the pool, so a block may outlive the pool, e.g. a
+// shape held past the world: it is still freed into the State, and the
+// slabs go back to the heap with the last of the pool and its allocators.
+// Blocks taken with Allocate() directly must be freed before the pool dies.
+class KBlockPool
+{
+public:
+	class State
+	{
+	public:
+		explicit State(uint32 blocksPerSlab) : m_blocksPerSlab(blocksPerSlab) {}
+		~State();
+		State(const State&) = delete;
+		State& operator=(const State&) = delete;
+
+		void* Allocate(size_t size);
+		void Free(void* p, size_t size);
+
+		size_t GetBlockSize() const { return m_blockSize; }
+		const KPoolStats& GetStats() const { return m_stats; }
+
+	private:
+		static size_t _GetBlockSize(size_t size);
+		void _AddSlab();
+
+	private:
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+
+		uint32				m_blocksPerSlab;
+		size_t				m_blockSize = 0;
+		FreeBlock*			m_freeList = nullptr;
+		std::vector<void*>	m_slabs;
+		KPoolStats			m_stats;
+	};
+
+	explicit KBlockPool(uint32 blocksPerSlab = 64) : m_state(std::make_shared<State>(blocksPerSlab)) {}
+	KBlockPool(const KBlockPool&) = delete;
+	KBlockPool& operator=(const KBlockPool&) = delete;
+
+	void* Allocate(size_t size) { return m_state->Allocate(size); }
+	void Free(void* p, size_t size) { m_state->Free(p, size); }
+
+	size_t GetBlockSize() const { return m_state->GetBlockSize(); }
+	const KPoolStats& GetStats() const { return m_state->GetStats(); }
+	const std::shared_ptr<State>& GetState() const { return m_state; }
+
+private:
+	std::shared_ptr<State>	m_state;
+};
+
+// Standard allocator over a KBlockPool, meant for std::allocate_shared() so
+// that an object and its shared_ptr control block take a single pool block.
+// The copy kept in the control block holds on to the pool's State.
+template <typename T>
+struct KPoolAllocator
+{
+	typedef T value_type;
+
+	explicit KPoolAllocator(const KBlockPool* pool) : state(pool->GetState()) {}
+	template <typename U>
+	KPoolAllocator(const KPoolAllocator<U>& rhs) : state(rhs.state) {}
+
+	T* allocate(size_t n) { return static_cast<T*>(state->Allocate(n * sizeof(T))); }
+	void deallocate(T* p, size_t n) { state->Free(p, n * sizeof(T)); }
+
+	template <typename U>
+	bool operator==(const KPoolAllocator<U>& rhs) const { return state == rhs.state; }
+	template <typename U>
+	bool operator!=(const KPoolAllocator<U>& rhs) const { return state != rhs.state; }
+
+	std::shared_ptr<KBlockPool::State> state;
+};
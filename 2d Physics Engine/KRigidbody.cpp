@@ -25,45 +25,81 @@ KRigidbody::KRigidbody(std::shared_ptr<KShape> shape_, float x, float y)
 	: shape(shape_)
 {
 	//shape->body = shared_from_this();// this;
-	position.Set((float)x, (float)y);
-	velocity.Set(0, 0);
-	angularVelocity = 0;
-	torque = 0;
-	rotation = Random(-PI, PI);
-	force.Set(0, 0);
-	staticFriction = 0.1f;
-	dynamicFriction = 0.05f;
-	restitution = 0.1f;
-	m_linearDamping = 0.1f;
-	m_angularDamping = 0.1f;
+	m_state.position.Set((float)x, (float)y);
+	m_state.rotation = Random(-PI, PI);
+	m_state.linearDamping = 0.1f;
+	m_state.angularDamping = 0.1f;
+}
+
+KRigidbody::~KRigidbody()
+{
+	// The shape may outlive its body if someone else still holds it
+	if (shape && shape->body == this)
+		shape->body = nullptr;
+	if (m_store)
+		m_store->Destroy(m_handle);
+}
+
+void KRigidbody::Attach(KBodyStore& store)
+{
+	assert(!m_store);
+	m_handle = store.Create(this, m_state);
+	m_store = &store;
+}
+
+void KRigidbody::Detach()
+{
+	if (!m_store)
+		return;
+
+	m_store->GetState(GetIndex(), m_state);
+	m_store->Destroy(m_handle);
+	m_store = nullptr;
+	m_handle = KBodyHandle();
 }
 
 void KRigidbody::ApplyImpulse(const KVector2& impulse, const KVector2& contactVector)
 {
-	velocity += m_invMass * impulse;
-	angularVelocity += m_invI * KVector2::Cross(contactVector, impulse);
+	SetVelocity(GetVelocity() + GetInvMass() * impulse);
+	SetAngularVelocity(GetAngularVelocity() + GetInvInertia() * KVector2::Cross(contactVector, impulse));
 }
 
 void KRigidbody::SetStatic()
 {
-	m_I = 0.0f;
-	m_invI = 0.0f;
-	m_mass = 0.0f;
-	m_invMass = 0.0f;
+	SetMassData(0.0f, 0.0f);
 }
 
 bool KRigidbody::IsStatic() const
 {
-	return m_I == 0.0f && m_mass == 0.0f;
+	return GetInertia() == 0.0f && GetMass() == 0.0f;
+}
+
+void KRigidbody::SetMassData(float mass, float inertia)
+{
+	_Get(&KBodyStore::mass, &KBodyState::mass) = mass;
+	_Get(&KBodyStore::invMass, &KBodyState::invMass) = (mass) ? 1.0f / mass : 0.0f;
+	_Get(&KBodyStore::inertia, &KBodyState::inertia) = inertia;
+	_Get(&KBodyStore::invInertia, &KBodyState::invInertia) = (inertia) ? 1.0f / inertia : 0.0f;
 }
 
 void KRigidbody::SetRotation(float radians)
 {
-	rotation = radians;
+	_Get(&KBodyStore::rotation, &KBodyState::rotation) = radians;
 }
 
 void KRigidbody::BodyToShape()
 {
-	shape->SetRotation(rotation);
-	shape->SetPosition(position);
+	shape->SetRotation(GetRotation());
+	shape->SetPosition(GetPosition());
+}
+
+void KRigidbody::_SetDamping(float linear, float angular)
+{
+	if (m_store)
+	{
+		m_store->SetDamping(GetIndex(), linear, angular);
+		return;
+	}
+	m_state.linearDamping = linear;
+	m_state.angularDamping = angular;
 }
@@ -25,42 +25,92 @@
 #include "KMath.h"
 #include <memory>
 #include "KShape.h"
+#include "KMaterial.h"
+#include "KBodyStore.h"
 
 struct KShape;
 struct KRigidbody;
+// Facade of a body stored in a KBodyStore. The simulation state lives in the
+// store's dense arrays, the accessors go through the body's handle.
+//
+// A body outside the world keeps its state in the facade instead: from its
+// creation until its Add() is flushed, and again once a Remove() is flushed
+// or the world is cleared. So a facade someone still holds stays safe to
+// read and write, it is just not simulated. Moving in and out of the store
+// copies the state and never allocates.
 struct KRigidbody : public std::enable_shared_from_this<KRigidbody>
 {
 	KRigidbody(std::shared_ptr<KShape> shape_, float x, float y);
+	~KRigidbody();
 	void ApplyImpulse(const KVector2& impulse, const KVector2& contactVector);
 	void SetStatic();
 	bool IsStatic() const;
 	void SetRotation(float radians);
 	void BodyToShape();
+	// Moves the state into and out of the world's store. Called by KWorld.
+	void Attach(KBodyStore& store);
+	void Detach();
+	bool IsDetached() const { return m_store == nullptr; }
 
-	KVector2 position;
-	KVector2 velocity;
+	KBodyHandle GetHandle() const { return m_handle; }
+	// Dense index into the store's arrays, changes when another body is removed
+	uint32 GetIndex() const { assert(m_store); return m_store->GetIndex(m_handle); }
 
-	float angularVelocity;
-	float torque;
-	float rotation; // radians
-
-	KVector2 force;
+	const KVector2& GetPosition() const { return _Get(&KBodyStore::position, &KBodyState::position); }
+	void SetPosition(const KVector2& position) { _Get(&KBodyStore::position, &KBodyState::position) = position; }
+	const KVector2& GetVelocity() const { return _Get(&KBodyStore::velocity, &KBodyState::velocity); }
+	void SetVelocity(const KVector2& velocity) { _Get(&KBodyStore::velocity, &KBodyState::velocity) = velocity; }
+	float GetRotation() const { return _Get(&KBodyStore::rotation, &KBodyState::rotation); } // radians
+	float GetAngularVelocity() const { return _Get(&KBodyStore::angularVelocity, &KBodyState::angularVelocity); }
+	void SetAngularVelocity(float angularVelocity) { _Get(&KBodyStore::angularVelocity, &KBodyState::angularVelocity) = angularVelocity; }
+	const KVector2& GetForce() const { return _Get(&KBodyStore::force, &KBodyState::force); }
+	void SetForce(const KVector2& force) { _Get(&KBodyStore::force, &KBodyState::force) = force; }
+	float GetTorque() const { return _Get(&KBodyStore::torque, &KBodyState::torque); }
+	void SetTorque(float torque) { _Get(&KBodyStore::torque, &KBodyState::torque) = torque; }
 
 	// Set by shape
-	float m_I;  // moment of inertia
-	float m_invI; // inverse inertia
-	float m_mass;  // mass
-	float m_invMass; // inverse mass
+	void SetMassData(float mass, float inertia);
+	float GetMass() const { return _Get(&KBodyStore::mass, &KBodyState::mass); }
+	float GetInvMass() const { return _Get(&KBodyStore::invMass, &KBodyState::invMass); }
+	float GetInertia() const { return _Get(&KBodyStore::inertia, &KBodyState::inertia); } // moment of inertia
+	float GetInvInertia() const { return _Get(&KBodyStore::invInertia, &KBodyState::invInertia); }
 
-	float staticFriction;
-	float dynamicFriction;
-	float restitution;
+	KMaterialId GetMaterial() const { return _Get(&KBodyStore::material, &KBodyState::material); } // index into KWorld::m_materials
+	void SetMaterial(KMaterialId material) { _Get(&KBodyStore::material, &KBodyState::material) = material; }
+	float32 GetLinearDamping() const { return _Get(&KBodyStore::linearDamping, &KBodyState::linearDamping); }
+	void SetLinearDamping(float32 damping) { _SetDamping(damping, GetAngularDamping()); }
+	float32 GetAngularDamping() const { return _Get(&KBodyStore::angularDamping, &KBodyState::angularDamping); }
+	void SetAngularDamping(float32 damping) { _SetDamping(GetLinearDamping(), damping); }
 
 	// KShape interface
 	std::shared_ptr<KShape> shape; // qff
 
-	float32 m_linearDamping;
-	float32 m_angularDamping;
+	// Set by KWorld
+	static const uint32 k_notInWorld = 0xffffffff;
+	uint32 m_worldIndex = k_notInWorld;	// position in KWorld::m_bodies
+	bool m_pendingAdd = false;			// KWorld::Add() was called, not flushed yet
+	bool m_pendingRemoval = false;		// KWorld::Remove() was called
+	// Added, or queued to be, and not removed
+	bool IsInWorld() const { return (m_worldIndex != k_notInWorld || m_pendingAdd) && !m_pendingRemoval; }
+
+private:
+	// A field of the store while attached, else of the detached state
+	template <typename T>
+	T& _Get(std::vector<T> KBodyStore::* field, T KBodyState::* detached)
+	{
+		return m_store ? (m_store->*field)[GetIndex()] : m_state.*detached;
+	}
+	template <typename T>
+	const T& _Get(std::vector<T> KBodyStore::* field, T KBodyState::* detached) const
+	{
+		return m_store ? (m_store->*field)[GetIndex()] : m_state.*detached;
+	}
+	void _SetDamping(float linear, float angular);
+
+private:
+	KBodyStore* m_store = nullptr;	// null while detached
+	KBodyHandle m_handle;
+	KBodyState m_state;				// while detached
 };
 
 #endif // BODY_H
\ No newline at end of file
@@ -53,7 +53,7 @@ public:
 	void SetPosition(const KVector2& pos_) { position = pos_; }
 
 public:
-	std::shared_ptr<KRigidbody> body;
+	KRigidbody* body; // not owned, the body owns its shape
 	KMatrix2 rotation; // Orientation matrix from model to world
 	KVector2 position;
 	// Store a color in RGB format
@@ -21,8 +21,8 @@ void KShapeUtil::Draw(KCircleShape& shape)
 
 	// Render line within circle so orientation is visible
 	KVector2 r(0, 1.0f);
-	float c = std::cos(shape.body->rotation);
-	float s = std::sin(shape.body->rotation);
+	float c = std::cos(shape.body->GetRotation());
+	float s = std::sin(shape.body->GetRotation());
 	r.Set(r.x * c - r.y * s, r.x * s + r.y * c);
 	r *= shape.radius;
 	r = r + shape.position;
@@ -36,7 +36,7 @@ void KShapeUtil::Draw(KPolygonShape& shape)
 	COLORREF color;
 	color = RGB(shape.r * 255.f, shape.g * 255.f, shape.b * 255.f);
 	std::vector<KVector2> points;
-	for (uint32 i = 0; i < shape.m_vertices.size(); ++i)
+	for (uint32 i = 0; i < shape.m_vertexCount; ++i)
 	{
 		KVector2 v = shape.position + shape.rotation * shape.m_vertices[i];
 		points.push_back(KVector2(v.x, v.y));
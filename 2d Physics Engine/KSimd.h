@@ -0,0 +1,105 @@
+#pragma once
+#include <cmath>
+
+// Thin wrapper over the widest float vector the build targets:
+// 8 lanes with AVX2 (/arch:AVX2), 4 lanes with SSE, or a plain 4-float
+// struct when no SIMD instruction set is available.
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+#define K_SIMD_WIDTH	8
+typedef __m256 KFloatW;
+
+inline KFloatW KZeroW() { return _mm256_setzero_ps(); }
+inline KFloatW KSplatW(float a) { return _mm256_set1_ps(a); }
+inline KFloatW KLoadW(const float* p) { return _mm256_load_ps(p); }
+inline void KStoreW(float* p, KFloatW a) { _mm256_store_ps(p, a); }
+// KLoadW() and KStoreW() need 32 byte alignment, the U variants do not
+inline KFloatW KLoadUW(const float* p) { return _mm256_loadu_ps(p); }
+inline void KStoreUW(float* p, KFloatW a) { _mm256_storeu_ps(p, a); }
+// p[0], p[0], p[1], p[1], ... from K_SIMD_WIDTH / 2 floats
+inline KFloatW KLoadPairsW(const float* p)
+{
+	const __m128 a = _mm_loadu_ps(p);
+	return _mm256_set_m128(_mm_unpackhi_ps(a, a), _mm_unpacklo_ps(a, a));
+}
+inline KFloatW KAddW(KFloatW a, KFloatW b) { return _mm256_add_ps(a, b); }
+inline KFloatW KSubW(KFloatW a, KFloatW b) { return _mm256_sub_ps(a, b); }
+inline KFloatW KMulW(KFloatW a, KFloatW b) { return _mm256_mul_ps(a, b); }
+inline KFloatW KMinW(KFloatW a, KFloatW b) { return _mm256_min_ps(a, b); }
+inline KFloatW KMaxW(KFloatW a, KFloatW b) { return _mm256_max_ps(a, b); }
+inline KFloatW KNegW(KFloatW a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+inline KFloatW KAbsW(KFloatW a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+// lane = a > b ? all ones : 0
+inline KFloatW KGreaterW(KFloatW a, KFloatW b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+// lane = mask ? b : a
+inline KFloatW KBlendW(KFloatW a, KFloatW b, KFloatW mask) { return _mm256_blendv_ps(a, b, mask); }
+inline KFloatW KOrW(KFloatW a, KFloatW b) { return _mm256_or_ps(a, b); }
+
+#elif defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+
+#include <xmmintrin.h>
+#define K_SIMD_WIDTH	4
+typedef __m128 KFloatW;
+
+inline KFloatW KZeroW() { return _mm_setzero_ps(); }
+inline KFloatW KSplatW(float a) { return _mm_set1_ps(a); }
+inline KFloatW KLoadW(const float* p) { return _mm_load_ps(p); }
+inline void KStoreW(float* p, KFloatW a) { _mm_store_ps(p, a); }
+inline KFloatW KLoadUW(const float* p) { return _mm_loadu_ps(p); }
+inline void KStoreUW(float* p, KFloatW a) { _mm_storeu_ps(p, a); }
+inline KFloatW KLoadPairsW(const float* p)
+{
+	const __m128 a = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)p);
+	return _mm_unpacklo_ps(a, a);
+}
+inline KFloatW KAddW(KFloatW a, KFloatW b) { return _mm_add_ps(a, b); }
+inline KFloatW KSubW(KFloatW a, KFloatW b) { return _mm_sub_ps(a, b); }
+inline KFloatW KMulW(KFloatW a, KFloatW b) { return _mm_mul_ps(a, b); }
+inline KFloatW KMinW(KFloatW a, KFloatW b) { return _mm_min_ps(a, b); }
+inline KFloatW KMaxW(KFloatW a, KFloatW b) { return _mm_max_ps(a, b); }
+inline KFloatW KNegW(KFloatW a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+inline KFloatW KAbsW(KFloatW a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline KFloatW KGreaterW(KFloatW a, KFloatW b) { return _mm_cmpgt_ps(a, b); }
+inline KFloatW KBlendW(KFloatW a, KFloatW b, KFloatW mask) { return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a)); }
+inline KFloatW KOrW(KFloatW a, KFloatW b) { return _mm_or_ps(a, b); }
+
+#else
+
+#define K_SIMD_WIDTH	4
+struct KFloatW { float v[K_SIMD_WIDTH]; };
+
+#define K_LANEWISE(expr) KFloatW r; for (int i = 0; i < K_SIMD_WIDTH; ++i) r.v[i] = (expr); return r
+inline KFloatW KZeroW() { K_LANEWISE(0.0f); }
+inline KFloatW KSplatW(float a) { K_LANEWISE(a); }
+inline KFloatW KLoadW(const float* p) { K_LANEWISE(p[i]); }
+inline void KStoreW(float* p, KFloatW a) { for (int i = 0; i < K_SIMD_WIDTH; ++i) p[i] = a.v[i]; }
+inline KFloatW KLoadUW(const float* p) { return KLoadW(p); }
+inline void KStoreUW(float* p, KFloatW a) { KStoreW(p, a); }
+inline KFloatW KLoadPairsW(const float* p) { K_LANEWISE(p[i / 2]); }
+inline KFloatW KAddW(KFloatW a, KFloatW b) { K_LANEWISE(a.v[i] + b.v[i]); }
+inline KFloatW KSubW(KFloatW a, KFloatW b) { K_LANEWISE(a.v[i] - b.v[i]); }
+inline KFloatW KMulW(KFloatW a, KFloatW b) { K_LANEWISE(a.v[i] * b.v[i]); }
+inline KFloatW KMinW(KFloatW a, KFloatW b) { K_LANEWISE(a.v[i] < b.v[i] ? a.v[i] : b.v[i]); }
+inline KFloatW KMaxW(KFloatW a, KFloatW b) { K_LANEWISE(a.v[i] > b.v[i] ? a.v[i] : b.v[i]); }
+inline KFloatW KNegW(KFloatW a) { K_LANEWISE(-a.v[i]); }
+inline KFloatW KAbsW(KFloatW a) { K_LANEWISE(std::abs(a.v[i])); }
+// the scalar mask is 0 or 1 instead of all bits
+inline KFloatW KGreaterW(KFloatW a, KFloatW b) { K_LANEWISE(a.v[i] > b.v[i] ? 1.0f : 0.0f); }
+inline KFloatW KBlendW(KFloatW a, KFloatW b, KFloatW mask) { K_LANEWISE(mask.v[i] != 0.0f ? b.v[i] : a.v[i]); }
+inline KFloatW KOrW(KFloatW a, KFloatW b) { K_LANEWISE(a.v[i] != 0.0f || b.v[i] != 0.0f ? 1.0f : 0.0f); }
+#undef K_LANEWISE
+
+#endif
+
+// Largest lane
+inline float KReduceMaxW(KFloatW a)
+{
+	alignas(32) float v[K_SIMD_WIDTH];
+	KStoreW(v, a);
+	float r = v[0];
+	for (int i = 1; i < K_SIMD_WIDTH; ++i)
+		r = v[i] > r ? v[i] : r;
+	return r;
+}
@@ -53,4 +53,21 @@ public:
             }
         }
     }
+
+    // Append the bodies of every cell the box overlaps. A body that spans
+    // several of those cells is appended once per cell.
+    void Query(const KAABB& box, std::vector<KRigidbody*>& bodies) const {
+        int minX = (int)floor(box.min.x / m_cellSize);
+        int maxX = (int)floor(box.max.x / m_cellSize);
+        int minY = (int)floor(box.min.y / m_cellSize);
+        int maxY = (int)floor(box.max.y / m_cellSize);
+
+        for (int x = minX; x <= maxX; ++x) {
+            for (int y = minY; y <= maxY; ++y) {
+                auto it = m_buckets.find({ x, y });
+                if (it != m_buckets.end())
+                    bodies.insert(bodies.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
 };
\ No newline at end of file
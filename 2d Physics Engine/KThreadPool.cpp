@@ -0,0 +1,92 @@
+#include "KThreadPool.h"
+
+KThreadPool::KThreadPool(uint32 numWorkers)
+{
+	m_workers.reserve(numWorkers);
+	for (uint32 i = 0; i < numWorkers; ++i)
+		m_workers.emplace_back(&KThreadPool::_WorkerMain, this, i);
+}
+
+KThreadPool::~KThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cvWork.notify_all();
+	for (std::thread& t : m_workers)
+		t.join();
+}
+
+void KThreadPool::Dispatch(uint32 numThreads, const std::function<void(uint32)>& job)
+{
+	numThreads = __min(numThreads, GetThreadCount());
+	if (numThreads <= 1)
+	{
+		job(0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_job = &job;
+		m_jobThreads = numThreads;
+		m_pending = numThreads - 1;
+		++m_generation;
+	}
+	m_cvWork.notify_all();
+
+	job(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cvDone.wait(lock, [this] { return m_pending == 0; });
+	m_job = nullptr;
+}
+
+void KThreadPool::ParallelFor(uint32 count, uint32 minBatch, const std::function<void(uint32, uint32)>& func)
+{
+	if (count == 0)
+		return;
+	minBatch = __max(minBatch, 1u);
+	const uint32 numThreads = __min(GetThreadCount(), (count + minBatch - 1) / minBatch);
+	const uint32 batch = __max(minBatch, count / (numThreads * 4));
+
+	std::atomic<uint32> next{ 0 };
+	Dispatch(numThreads, [&](uint32)
+	{
+		for (;;)
+		{
+			const uint32 begin = next.fetch_add(batch);
+			if (begin >= count)
+				break;
+			func(begin, __min(begin + batch, count));
+		}
+	});
+}
+
+void KThreadPool::_WorkerMain(uint32 workerIndex)
+{
+	uint32 seenGeneration = 0;
+	for (;;)
+	{
+		const std::function<void(uint32)>* job = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cvWork.wait(lock, [&] { return m_stop || m_generation != seenGeneration; });
+			if (m_stop)
+				return;
+			seenGeneration = m_generation;
+			if (workerIndex + 1 < m_jobThreads)
+				job = m_job;
+		}
+
+		if (job == nullptr)
+			continue;
+
+		(*job)(workerIndex + 1);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (--m_pending == 0)
+			m_cvDone.notify_one();
+	}
+}
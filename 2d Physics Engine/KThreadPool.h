@@ -0,0 +1,67 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <cstdlib> // __min, __max
+#include "KMath.h"
+
+// Fixed set of worker threads. The calling thread always takes part in the
+// work, so a pool created with 0 workers simply runs everything inline.
+class KThreadPool
+{
+public:
+	explicit KThreadPool(uint32 numWorkers);
+	~KThreadPool();
+
+	// workers + the calling thread
+	uint32 GetThreadCount() const { return (uint32)m_workers.size() + 1; }
+
+	// Runs job(threadIndex) exactly once on each of the first numThreads threads
+	// (index 0 is the caller) and blocks until all of them returned.
+	void Dispatch(uint32 numThreads, const std::function<void(uint32)>& job);
+
+	// Runs func(begin, end) over [0, count) in batches of at least minBatch items.
+	void ParallelFor(uint32 count, uint32 minBatch, const std::function<void(uint32, uint32)>& func);
+
+private:
+	void _WorkerMain(uint32 workerIndex);
+
+private:
+	std::vector<std::thread>			m_workers;
+	std::mutex							m_mutex;
+	std::condition_variable				m_cvWork;
+	std::condition_variable				m_cvDone;
+	const std::function<void(uint32)>*	m_job = nullptr;
+	uint32								m_jobThreads = 0;
+	uint32								m_pending = 0;
+	uint32								m_generation = 0;
+	bool								m_stop = false;
+};
+
+// Barrier for threads running inside the same KThreadPool::Dispatch().
+// Spins instead of sleeping since the solver crosses it many times per step.
+class KSpinBarrier
+{
+public:
+	explicit KSpinBarrier(uint32 count) : m_count(count) {}
+	void Wait()
+	{
+		const uint32 generation = m_generation.load(std::memory_order_acquire);
+		if (m_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == m_count)
+		{
+			m_arrived.store(0, std::memory_order_relaxed);
+			m_generation.fetch_add(1, std::memory_order_acq_rel);
+			return;
+		}
+		while (m_generation.load(std::memory_order_acquire) == generation)
+			std::this_thread::yield();
+	}
+
+private:
+	uint32					m_count;
+	std::atomic<uint32>		m_arrived{ 0 };
+	std::atomic<uint32>		m_generation{ 0 };
+};
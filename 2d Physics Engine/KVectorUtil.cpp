@@ -4,6 +4,7 @@
 #include <math.h>
 #include "KMath.h"
 #include <windowsx.h>
+#include "KSimd.h"
 
 #pragma warning(disable:4244)
 
@@ -236,6 +237,116 @@ float KVectorUtil::PointLineDistance(KVector2 p, KVector2 v0, KVector2 v1)
 	return CD;
 }
 
+bool KVectorUtil::IsPointInConvexPolygon(const KVector2& p, const KVector2* points, int numPoints)
+{
+	if (numPoints <= 2)
+		return false;
+
+	// Outside the wedge of the first and last edge
+	const KVector2& v0 = points[0];
+	const KVector2 d = p - v0;
+	if (KVector2::Cross(points[1] - v0, d) <= 0.0f || KVector2::Cross(points[numPoints - 1] - v0, d) >= 0.0f)
+		return false;
+
+	// The wedge (v0, v[lo], v[lo + 1]) that holds p
+	int lo = 1;
+	int hi = numPoints - 1;
+	while (hi - lo > 1)
+	{
+		const int mid = (lo + hi) / 2;
+		if (KVector2::Cross(points[mid] - v0, d) > 0.0f)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	return KVector2::Cross(points[lo + 1] - points[lo], p - points[lo]) > 0.0f;
+}
+
+void KVectorUtil::IsPointInConvexPolygon(const KVector2* queries, int numQueries, const KVector2* points, int numPoints
+	, bool* inside)
+{
+	if (numPoints <= 2)
+	{
+		for (int q = 0; q < numQueries; ++q)
+			inside[q] = false;
+		return;
+	}
+
+	// A point is inside if it is left of every edge, that is if the smallest
+	// edge cross product is positive
+	int q = 0;
+	for (; q + K_SIMD_WIDTH <= numQueries; q += K_SIMD_WIDTH)
+	{
+		alignas(32) float x[K_SIMD_WIDTH];
+		alignas(32) float y[K_SIMD_WIDTH];
+		for (int k = 0; k < K_SIMD_WIDTH; ++k)
+		{
+			x[k] = queries[q + k].x;
+			y[k] = queries[q + k].y;
+		}
+		const KFloatW qx = KLoadW(x);
+		const KFloatW qy = KLoadW(y);
+
+		KFloatW minCross = KSplatW(FLT_MAX);
+		KVector2 vi = points[numPoints - 1];
+		for (int k = 0; k < numPoints; ++k)
+		{
+			const KVector2 vk = points[k];
+			const KVector2 e = vk - vi;
+			const KFloatW dx = KSubW(qx, KSplatW(vi.x));
+			const KFloatW dy = KSubW(qy, KSplatW(vi.y));
+			const KFloatW cross = KSubW(KMulW(KSplatW(e.x), dy), KMulW(KSplatW(e.y), dx));
+			minCross = KMinW(minCross, cross);
+			vi = vk;
+		}
+
+		alignas(32) float result[K_SIMD_WIDTH];
+		KStoreW(result, minCross);
+		for (int k = 0; k < K_SIMD_WIDTH; ++k)
+			inside[q + k] = result[k] > 0.0f;
+	}
+	for (; q < numQueries; ++q)
+		inside[q] = IsPointInConvexPolygon(queries[q], points, numPoints);
+}
+
+bool KVectorUtil::LineSegmentConvexPolygonCrossing(const KVector2& p0, const KVector2& p1, const KVector2* points
+	, int numPoints, float& tEnter, float& tExit)
+{
+	// Cyrus-Beck: each edge bounds t from one side. The outward edge normal
+	// is left unnormalized, only the ratio of the two dot products counts.
+	const KVector2 r = p1 - p0;
+	tEnter = 0.0f;
+	tExit = 1.0f;
+	KVector2 vi = points[numPoints - 1];
+	for (int k = 0; k < numPoints; ++k)
+	{
+		const KVector2 vk = points[k];
+		const KVector2 e = vk - vi;
+		const KVector2 n(e.y, -e.x);
+
+		// Inside the edge while Dot(n, p0 + t * r - vi) <= 0
+		const float num = KVector2::Dot(n, vi - p0);
+		const float den = KVector2::Dot(n, r);
+		if (den == 0.0f)
+		{
+			if (num < 0.0f)
+				return false;
+		}
+		else if (den < 0.0f)
+		{
+			tEnter = __max(tEnter, num / den);
+		}
+		else
+		{
+			tExit = __min(tExit, num / den);
+		}
+		if (tEnter > tExit)
+			return false;
+		vi = vk;
+	}
+	return true;
+}
+
 bool KVectorUtil::IsPointInPolygon(const KVector2& p, const std::vector<KVector2>& points)
 {
 	const int numPoints = points.size();
@@ -310,17 +421,44 @@ bool KVectorUtil::LineSegementsIntersect(KVector2 p, KVector2 p2, KVector2 q, KV
 int KVectorUtil::LineSegmentPolygonIntersection(const KVector2& p0, const KVector2& p1
 	, const std::vector<KVector2>& points, std::vector<KVector2>& intersections)
 {
-	KVector2 collPoint;
+	const size_t first = intersections.size();
+	intersections.resize(first + points.size());
+	const int numIntersection = LineSegmentPolygonIntersection(p0, p1, points.data(), (int)points.size()
+		, &intersections[first]);
+	intersections.resize(first + numIntersection);
+	return numIntersection;
+}
+
+int KVectorUtil::LineSegmentPolygonIntersection(const KVector2& p0, const KVector2& p1
+	, const KVector2* points, int numPoints, KVector2* intersections)
+{
+	if (numPoints == 0)
+		return 0;
+
+	// An edge crosses the line where the signed distances of its ends change
+	// sign, the crossing then only has to lie within the segment
+	const KVector2 r = p1 - p0;
+	const float rr = KVector2::Dot(r, r);
 	int numIntersection = 0;
-	for (uint32 i = 0; i < points.size(); ++i)
+	KVector2 vi = points[numPoints - 1];
+	float di = KVector2::Cross(r, vi - p0);
+	for (int k = 0; k < numPoints; ++k)
 	{
-		const int i0 = i;
-		const int i1 = (i + 1) % points.size();
-		const bool isIntersect = KVectorUtil::LineSegementsIntersect(p0, p1, points[i0], points[i1], collPoint);
-		if (isIntersect) {
-			intersections.push_back(collPoint);
-			numIntersection += 1;
+		const KVector2 vk = points[k];
+		const float dk = KVector2::Cross(r, vk - p0);
+		if (di != dk && ((di <= 0.0f && dk >= 0.0f) || (di >= 0.0f && dk <= 0.0f)))
+		{
+			const KVector2 x = vi + (di / (di - dk)) * (vk - vi);
+			const float u = KVector2::Dot(x - p0, r);
+			if (u >= 0.0f && u <= rr)
+			{
+				if (intersections != nullptr)
+					intersections[numIntersection] = x;
+				numIntersection += 1;
+			}
 		}
+		vi = vk;
+		di = dk;
 	}
 	return numIntersection;
 }
@@ -367,6 +505,10 @@ void KVectorUtil::Clip(const std::vector<KVector2>& points, const KVector2 p0, c
 		// w.r.t. clipper line
 		float k_pos = (p1.x - p0.x) * (vk.y - p0.y) - (p1.y - p0.y) * (vk.x - p0.x);
 
+		// Point of intersection of the edge with the clipper line, the
+		// line may end short of the edge
+		auto intersect = [&]() { return vi + (i_pos / (i_pos - k_pos)) * (vk - vi); };
+
 		// Case 1 : When both points are inside
 		if (i_pos < 0 && k_pos < 0)
 		{
@@ -378,18 +520,14 @@ void KVectorUtil::Clip(const std::vector<KVector2>& points, const KVector2 p0, c
 		{
 			// Point of intersection with edge
 			// and the second point is added
-			KVector2 intersect;
-			KVectorUtil::LineSegementsIntersect(p0, p1, vi, vk, intersect);
-			new_points.push_back(intersect);
+			new_points.push_back(intersect());
 			new_points.push_back(vk);
 		}
 		// Case 3: When only second point is outside
 		else if (i_pos < 0 && k_pos >= 0)
 		{
 			//Only point of intersection with edge is added
-			KVector2 intersect;
-			KVectorUtil::LineSegementsIntersect(p0, p1, vi, vk, intersect);
-			new_points.push_back(intersect);
+			new_points.push_back(intersect());
 		}
 		// Case 4: When both points are outside
 		else
@@ -399,6 +537,54 @@ void KVectorUtil::Clip(const std::vector<KVector2>& points, const KVector2 p0, c
 	}
 }
 
+int KVectorUtil::ClipConvex(const KVector2* points, int numPoints, const KVector2& p0, const KVector2& p1
+	, KVector2* out)
+{
+	int numFront = 0;
+	int numBack = 0;
+	SplitConvex(points, numPoints, p0, p1, out, numFront, nullptr, numBack);
+	return numFront;
+}
+
+bool KVectorUtil::SplitConvex(const KVector2* points, int numPoints, const KVector2& p0, const KVector2& p1
+	, KVector2* front, int& numFront, KVector2* back, int& numBack)
+{
+	numFront = 0;
+	numBack = 0;
+	if (numPoints == 0)
+		return false;
+
+	// Each edge is visited once with the signed distances of both ends, the
+	// distance of a vertex is computed once and carried to the next edge.
+	// A vertex on the line goes to both halves.
+	const KVector2 r = p1 - p0;
+	KVector2 vi = points[numPoints - 1];
+	float di = KVector2::Cross(r, vi - p0);
+	for (int k = 0; k < numPoints; ++k)
+	{
+		const KVector2 vk = points[k];
+		const float dk = KVector2::Cross(r, vk - p0);
+
+		// The edge crosses the line strictly between its ends
+		if ((di < 0.0f && dk > 0.0f) || (di > 0.0f && dk < 0.0f))
+		{
+			const KVector2 x = vi + (di / (di - dk)) * (vk - vi);
+			front[numFront++] = x;
+			if (back != nullptr)
+				back[numBack++] = x;
+		}
+
+		if (dk <= 0.0f)
+			front[numFront++] = vk;
+		if (dk >= 0.0f && back != nullptr)
+			back[numBack++] = vk;
+
+		vi = vk;
+		di = dk;
+	}
+	return numFront >= 3 && numBack >= 3;
+}
+
 static HPEN s_SharedBorderPen = CreatePen(PS_SOLID, 2, RGB(0, 0, 0));
 
 void KVectorUtil::DrawPolygon(HDC hdc, std::vector<KVector2>& vertices, COLORREF color)
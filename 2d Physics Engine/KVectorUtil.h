@@ -32,14 +32,38 @@ namespace KVectorUtil
 	/// check whether point p is in the convex polygon of 'points'
 	bool IsPointInPolygon(const KVector2& p, const std::vector<KVector2>& points);
 	bool IsPointInPolygon(const KVector2& p, const KVector2* points, int numPoints);
+	/// same result in O(log n) for a counter-clockwise convex polygon, by binary search over the
+	/// wedges the diagonals from points[0] form
+	bool IsPointInConvexPolygon(const KVector2& p, const KVector2* points, int numPoints);
+	/// tests numQueries points at once, K_SIMD_WIDTH at a time. inside holds numQueries results.
+	void IsPointInConvexPolygon(const KVector2* queries, int numQueries, const KVector2* points, int numPoints
+		, bool* inside);
+	/// clip the segment p0 + t * (p1 - p0), t in [0, 1], to a counter-clockwise convex polygon.
+	/// returns false if it misses, else the part inside is [tEnter, tExit]:
+	/// tEnter > 0 if p0 is outside and tExit < 1 if p1 is outside.
+	bool LineSegmentConvexPolygonCrossing(const KVector2& p0, const KVector2& p1, const KVector2* points, int numPoints
+		, float& tEnter, float& tExit);
 	bool LineSegementsIntersect(KVector2 p0, KVector2 p1, KVector2 q0, KVector2 q1
 		, KVector2& out, bool considerCollinearOverlapAsIntersect = false);
 	int LineSegmentPolygonIntersection(const KVector2& p0, const KVector2& p1, const std::vector<KVector2>& points
 		, std::vector<KVector2>& intersections);
+	/// same for a convex polygon without allocation. intersections holds numPoints points or is nullptr.
+	int LineSegmentPolygonIntersection(const KVector2& p0, const KVector2& p1, const KVector2* points, int numPoints
+		, KVector2* intersections = nullptr);
     KVector2 GetGeoCenter(const KVector2* points, int vertexCount);
     KVector2 GetGeoCenter(const std::vector<KVector2>& points);
+	/// Sutherland-Hodgman: clip any polygon to the half plane Cross(p1 - p0, p - p0) < 0, p0 and p1 only
+	/// name the line. appends to outPoints.
 	void Clip(const std::vector<KVector2>& inPoints, const KVector2 p0, const KVector2 p1
 		, std::vector<KVector2>& outPoints);
+	/// clip a convex polygon to the half plane Cross(p1 - p0, p - p0) <= 0 in one pass.
+	/// out holds numPoints + 1 points. returns the number of points written.
+	int ClipConvex(const KVector2* points, int numPoints, const KVector2& p0, const KVector2& p1, KVector2* out);
+	/// split a convex polygon along the line through p0 and p1 in one pass. front gets the half ClipConvex()
+	/// keeps and back the other one, both hold numPoints + 1 points.
+	/// returns false unless the line cuts the polygon in two.
+	bool SplitConvex(const KVector2* points, int numPoints, const KVector2& p0, const KVector2& p1
+		, KVector2* front, int& numFront, KVector2* back, int& numBack);
 	void DrawPolygon(HDC hdc, std::vector<KVector2>& points, COLORREF color);
 	/// <summary>
 	/// check whether vector bc is rotated CCW or CW with respect to ab.
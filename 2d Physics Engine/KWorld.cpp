@@ -3,6 +3,9 @@
 */
 
 #include "KPhysicsEngine.h"
+#include "KSimd.h"
+#include "KConvexHull.h"
+#include <algorithm>
 
 const float			KWorld::gravityScale = 3.0f; // original 5.0f. 20210428_jintaeks
 //const float		KWorld::gravityScale = 0.0f; // test
@@ -10,50 +13,121 @@ const KVector2		KWorld::gravity(0, 9.8f * gravityScale);
 const float			KWorld::dt = 1.0f / 60.0f;
 bool				KWorld::frameStepping = false;
 bool				KWorld::canStep = false;
+const float			KWorld::k_sliceMargin = 1.0f;
 
-void IntegrateForces(std::shared_ptr<KRigidbody> b, float dt)
-{
-	if (b->m_invMass == 0.0f)
-		return;
-
-	b->velocity += (b->force * b->m_invMass + KWorld::gravity) * dt;
-	b->angularVelocity += b->torque * b->m_invI * dt;
+// The integration kernels run K_SIMD_WIDTH bodies at a time with static
+// bodies masked out. Linear state is interleaved (x, y), so those vectors
+// hold half as many bodies and per-body values are loaded with KLoadPairsW().
+static_assert(sizeof(KVector2) == 2 * sizeof(float), "KVector2 must be two packed floats");
 
+void IntegrateForces(KBodyStore& bodies, float dt)
+{
 	// Apply damping.
 	// ODE: dv/dt + c * v = 0
 	// Solution: v(t) = v0 * exp(-c * t)
 	// Time step: v(t + dt) = v0 * exp(-c * (t + dt)) 
 	//                      = v0 * exp(-c * t) * exp(-c * dt) = v * exp(-c * dt)
 	// v2 = exp(-c * dt) * v1
-	b->velocity *= std::exp(-(b->m_linearDamping)*dt);
-	b->angularVelocity *= std::exp(-(b->m_linearDamping)*dt);
+	// exp(-c * dt) is cached by the store.
+	bodies.SetDecayDt(dt);
 
 	//// Pade approximation:
 	//// v2 = v1 * 1 / (1 + c * dt)
 	//// https://en.wikipedia.org/wiki/Pad%C3%A9_approximant
-	//b->velocity *= 1.0f / (1.0f + dt * b->m_linearDamping);
-	//b->angularVelocity *= 1.0f / (1.0f + dt * b->m_angularDamping);
+
+	const uint32 numBodies = bodies.GetCount();
+	float* velocity = reinterpret_cast<float*>(bodies.velocity.data());
+	const float* force = reinterpret_cast<const float*>(bodies.force.data());
+
+	alignas(32) float gravity[K_SIMD_WIDTH];
+	for (uint32 k = 0; k < K_SIMD_WIDTH; ++k)
+		gravity[k] = KWorld::gravity.v[k & 1];
+	const KFloatW g = KLoadW(gravity);
+	const KFloatW h = KSplatW(dt);
+	const KFloatW zero = KZeroW();
+
+	uint32 i = 0;
+	for (; i + K_SIMD_WIDTH <= numBodies; i += K_SIMD_WIDTH)
+	{
+		for (uint32 j = i; j < i + K_SIMD_WIDTH; j += K_SIMD_WIDTH / 2)
+		{
+			const KFloatW invMass = KLoadPairsW(&bodies.invMass[j]);
+			const KFloatW v = KLoadUW(velocity + 2 * j);
+			KFloatW r = KAddW(v, KMulW(KAddW(KMulW(KLoadUW(force + 2 * j), invMass), g), h));
+			r = KMulW(r, KLoadPairsW(&bodies.linearDecay[j]));
+			KStoreUW(velocity + 2 * j, KBlendW(v, r, KGreaterW(invMass, zero)));
+		}
+
+		const KFloatW invMass = KLoadUW(&bodies.invMass[i]);
+		const KFloatW w = KLoadUW(&bodies.angularVelocity[i]);
+		KFloatW r = KAddW(w, KMulW(KMulW(KLoadUW(&bodies.torque[i]), KLoadUW(&bodies.invInertia[i])), h));
+		r = KMulW(r, KLoadUW(&bodies.angularDecay[i]));
+		KStoreUW(&bodies.angularVelocity[i], KBlendW(w, r, KGreaterW(invMass, zero)));
+	}
+
+	for (; i < numBodies; ++i)
+	{
+		const float invMass = bodies.invMass[i];
+		if (invMass == 0.0f)
+			continue;
+
+		bodies.velocity[i] += (bodies.force[i] * invMass + KWorld::gravity) * dt;
+		bodies.angularVelocity[i] += bodies.torque[i] * bodies.invInertia[i] * dt;
+		bodies.velocity[i] *= bodies.linearDecay[i];
+		bodies.angularVelocity[i] *= bodies.angularDecay[i];
+	}
 }
 
-void IntegrateVelocity(std::shared_ptr<KRigidbody> b, float dt)
+void IntegrateVelocity(KBodyStore& bodies, float dt)
 {
-	if (b->m_invMass == 0.0f)
-		return;
+	const uint32 numBodies = bodies.GetCount();
+	float* position = reinterpret_cast<float*>(bodies.position.data());
+	const float* velocity = reinterpret_cast<const float*>(bodies.velocity.data());
+	const KFloatW h = KSplatW(dt);
+	const KFloatW zero = KZeroW();
+
+	uint32 i = 0;
+	for (; i + K_SIMD_WIDTH <= numBodies; i += K_SIMD_WIDTH)
+	{
+		for (uint32 j = i; j < i + K_SIMD_WIDTH; j += K_SIMD_WIDTH / 2)
+		{
+			const KFloatW p = KLoadUW(position + 2 * j);
+			const KFloatW r = KAddW(p, KMulW(KLoadUW(velocity + 2 * j), h));
+			KStoreUW(position + 2 * j, KBlendW(p, r, KGreaterW(KLoadPairsW(&bodies.invMass[j]), zero)));
+		}
+
+		const KFloatW a = KLoadUW(&bodies.rotation[i]);
+		const KFloatW r = KAddW(a, KMulW(KLoadUW(&bodies.angularVelocity[i]), h));
+		KStoreUW(&bodies.rotation[i], KBlendW(a, r, KGreaterW(KLoadUW(&bodies.invMass[i]), zero)));
+	}
+
+	for (; i < numBodies; ++i)
+	{
+		if (bodies.invMass[i] == 0.0f)
+			continue;
 
-	b->position += b->velocity * dt;
-	b->rotation += b->angularVelocity * dt;
+		bodies.position[i] += bodies.velocity[i] * dt;
+		bodies.rotation[i] += bodies.angularVelocity[i] * dt;
+	}
 }
 
 /*static*/ KWorld& KWorld::Singleton()
 {
-	static KWorld instance(KWorld::dt, 20);
+	static KWorld instance(KWorld::dt, 4, 20);
 	return instance;
 }
 
 // constructor
-KWorld::KWorld(float dt, uint32 iterations) 
-	: m_dt(dt), m_iterations(iterations)
+KWorld::KWorld(float dt, uint32 minIterations, uint32 maxIterations) 
+	: m_dt(dt), m_minIterations(minIterations), m_maxIterations(maxIterations)
+	, m_threadPool(__min(__max(std::thread::hardware_concurrency(), 1u) - 1, 7u))
+{
+	m_contactSolver.SetThreadPool(&m_threadPool);
+}
+
+KWorld::~KWorld()
 {
+	Clear();
 }
 
 struct PairHash
@@ -95,7 +169,7 @@ void KWorld::GenerateCollisionInfo()
 				KRigidbody* B = bucket[j];
 
 				// Optimization: Ignore collision if both bodies are static
-				if (A->m_invMass == 0 && B->m_invMass == 0) continue;
+				if (A->GetInvMass() == 0 && B->GetInvMass() == 0) continue;
 
 				// --- DUPLICATE CHECK ---
 				// Normalize pair order to ensure {A, B} is treated same as {B, A}
@@ -124,105 +198,151 @@ void KWorld::GenerateCollisionInfo()
 	}
 }
 
-bool KWorld::_IsBodyInRemoveCandidate(std::shared_ptr<KRigidbody> body_)
+void KWorld::_FlushCommands()
 {
-	for (uint32 i = 0; i < m_removeCandidates.size(); ++i) {
-		std::shared_ptr<KRigidbody> body = m_removeCandidates[i];
-		if (body == body_)
-			return true;
-	}
-	return false;
-}
+	for (Command& command : m_commands)
+	{
+		KRigidbody& body = *command.body;
+		if (command.type == Command::eAdd)
+		{
+			body.m_pendingAdd = false;
+			body.m_worldIndex = (uint32)m_bodies.size();
+			m_bodies.push_back(command.body);
+			body.Attach(m_bodyStore);
+			continue;
+		}
 
-void KWorld::_RemoveRigidbody()
-{
-	for (uint32 i = 0; i < m_removeCandidates.size(); ++i) {
-		std::shared_ptr<KRigidbody> body = m_removeCandidates[i];
-		m_bodies.erase(std::remove_if(m_bodies.begin(), m_bodies.end()
-			,[body](std::shared_ptr<KRigidbody> body_) { return body == body_; })
-			, m_bodies.end());
+		// Remove() only queues bodies in the world, an Add() before it was flushed first
+		const uint32 i = body.m_worldIndex;
+		assert(i != KRigidbody::k_notInWorld);
+
+		// Swap and pop
+		if (i + 1 != (uint32)m_bodies.size())
+		{
+			m_bodies[i] = m_bodies.back();
+			m_bodies[i]->m_worldIndex = i;
+		}
+		m_bodies.pop_back();
+		body.m_worldIndex = KRigidbody::k_notInWorld;
+		body.Detach();
 	}
+	m_commands.clear();
 }
 
 void KWorld::Step()
 {
-	_RemoveRigidbody();
+	_FlushCommands();
 	// Generate new collision info
 	GenerateCollisionInfo();
 
-	// Integrate forces
-	for (uint32 i = 0; i < m_bodies.size(); ++i)
-		IntegrateForces(m_bodies[i], m_dt);
-
-	// Initialize collision
-	for (uint32 i = 0; i < m_contacts.size(); ++i)
-		m_contacts[i].Initialize();
+	if (m_subSteps > 0)
+	{
+		// Integrate and solve collisions in sub-steps
+		m_contactSolver.Initialize(m_bodyStore, m_contacts, m_materials, m_dt);
+		m_contactSolver.SoftStep(m_bodyStore, m_dt, m_subSteps, m_contactHertz, m_contactDampingRatio);
+	}
+	else
+	{
+		// Integrate forces
+		IntegrateForces(m_bodyStore, m_dt);
 
-	// Solve collisions
-	for (uint32 j = 0; j < m_iterations; ++j)
-		for (uint32 i = 0; i < m_contacts.size(); ++i)
-			m_contacts[i].ApplyImpulse();
+		// Initialize collision
+		m_contactSolver.Initialize(m_bodyStore, m_contacts, m_materials, m_dt);
 
-	// Integrate velocities
-	for (uint32 i = 0; i < m_bodies.size(); ++i)
-		IntegrateVelocity(m_bodies[i], m_dt);
+		// Solve collisions
+		m_contactSolver.Solve(m_minIterations, m_maxIterations);
+		m_contactSolver.StoreVelocities(m_bodyStore);
 
-	// Correct positions
-	for (uint32 i = 0; i < m_contacts.size(); ++i)
-		m_contacts[i].PositionalCorrection();
+		// Integrate velocities
+		IntegrateVelocity(m_bodyStore, m_dt);
 
-	// Clear all forces
-	for (uint32 i = 0; i < m_bodies.size(); ++i)
-	{
-		std::shared_ptr<KRigidbody> b = m_bodies[i];
-		b->force.Set(0, 0);
-		b->torque = 0;
+		// Correct positions
+		m_contactSolver.SolvePositions(m_bodyStore);
 	}
 
-	// Update shape data from rigidbody
-	for (std::shared_ptr<KRigidbody> body : m_bodies)
+	// Clear all forces and update shape data from rigidbody in one pass
+	for (uint32 i = 0; i < m_bodyStore.GetCount(); ++i)
 	{
+		m_bodyStore.force[i] = KVector2::zero;
+		m_bodyStore.torque[i] = 0.0f;
+
 		// qff
-		body->BodyToShape();
+		KShape& shape = *m_bodyStore.owner[i]->shape;
+		shape.SetRotation(m_bodyStore.rotation[i]);
+		shape.SetPosition(m_bodyStore.position[i]);
 	}
 }
 
 std::shared_ptr<KRigidbody> KWorld::CreateRigidbody(std::shared_ptr<KShape> shape, float x, float y)
 {
-	assert(shape);
-	std::shared_ptr<KRigidbody> b;
-	b.reset(new KRigidbody(shape, x, y));
-	shape->body = b;
+	std::shared_ptr<KRigidbody> b = _NewRigidbody(shape, x, y);
 	shape->Initialize();
-	b->restitution = 0.2f;
-	b->dynamicFriction = 0.2f;
-	b->staticFriction = 0.4f;
+	return b;
+}
+
+std::shared_ptr<KRigidbody> KWorld::_NewRigidbody(std::shared_ptr<KShape> shape, float x, float y)
+{
+	assert(shape);
+	std::shared_ptr<KRigidbody> b = std::allocate_shared<KRigidbody>(KPoolAllocator<KRigidbody>(&m_bodyPool),
+		shape, x, y);
+	shape->body = b.get();
 	return b;
 }
 
 std::shared_ptr<KRigidbody> KWorld::Add(std::shared_ptr<KShape> shape, float x, float y)
 {
 	std::shared_ptr<KRigidbody> b = CreateRigidbody(shape, x, y);
-	m_bodies.push_back(b);
+	b->m_pendingAdd = true;
+	m_commands.push_back(Command{ Command::eAdd, b });
 	return b;
 }
 
 bool KWorld::Remove(std::shared_ptr<KRigidbody> body)
 {
-	m_removeCandidates.push_back(body);
+	if (!body || !body->IsInWorld())
+		return false;
+
+	body->m_pendingRemoval = true;
+	m_commands.push_back(Command{ Command::eRemove, body });
 	return true;
 }
 
 void KWorld::Clear()
 {
+	// Facades still held elsewhere keep their state
+	for (std::shared_ptr<KRigidbody>& body : m_bodies)
+	{
+		body->m_worldIndex = KRigidbody::k_notInWorld;
+		body->Detach();
+	}
+	for (Command& command : m_commands)
+		command.body->m_pendingAdd = false;
 	m_bodies.clear();
+	m_commands.clear();
+	m_fragments.clear();
+	m_bodyStore.Clear();
 	m_contacts.clear();
+	m_spatialHash.Clear();
+}
+
+KPoolStats KWorld::GetPoolStats() const
+{
+	KPoolStats stats;
+	const KBlockPool* pools[] = { &m_geometryPool, &m_bodyPool, &m_circlePool, &m_polygonPool };
+	for (const KBlockPool* pool : pools)
+	{
+		stats.allocations += pool->GetStats().allocations;
+		stats.liveBlocks += pool->GetStats().liveBlocks;
+		stats.slabs += pool->GetStats().slabs;
+		stats.heapAllocations += pool->GetStats().heapAllocations;
+	}
+	return stats;
 }
 
 std::shared_ptr<KShape> KWorld::CreateCircle(float radius, float x, float y, bool isStatic)
 {
-	std::shared_ptr<KCircleShape> c;
-	c.reset(new KCircleShape((float)radius));
+	std::shared_ptr<KCircleShape> c = std::allocate_shared<KCircleShape>(KPoolAllocator<KCircleShape>(&m_circlePool),
+		(float)radius);
 	std::shared_ptr<KRigidbody> body = Add(c, x, y);
 	body->BodyToShape();
 	if (isStatic)
@@ -231,32 +351,48 @@ std::shared_ptr<KShape> KWorld::CreateCircle(float radius, float x, float y, boo
 	return c;
 }
 
-std::shared_ptr<KShape> KWorld::CreatePolygon(KVector2* vertices, uint32 numVertices, float x, float y, bool isStatic)
+std::shared_ptr<KShape> KWorld::CreatePolygon(const KVector2* vertices, uint32 numVertices, float x, float y, bool isStatic)
 {
-	std::shared_ptr<KPolygonShape> polygon;
-	polygon.reset(new KPolygonShape());
+	KBodyDesc desc;
+	desc.type = KShape::ePoly;
+	desc.vertices = vertices;
+	desc.numVertices = numVertices;
+
+	// Hull large point clouds on all threads first
+	std::vector<KVector2> hull;
+	if (numVertices >= k_parallelHullPoints)
 	{
-		polygon->Set(vertices, numVertices);
-		std::shared_ptr<KRigidbody> body = Add(polygon, 0, 0);
-		body->shape->ComputeMass(1.0f);
-		body->SetRotation(0);
-		body->restitution = 0.2f;
-		body->dynamicFriction = 0.2f;
-		body->staticFriction = 0.4f;
-		body->position = KVector2(x, y);
-		body->BodyToShape();
-		if (isStatic)
-			body->SetStatic();
+		hull.resize(3 * numVertices);
+		desc.numVertices = KConvexHull::ComputeParallel(vertices, numVertices, &hull[0], &hull[2 * numVertices], m_threadPool);
+		desc.vertices = &hull[0];
 	}
-	return polygon;
+	desc.position = KVector2(x, y);
+	desc.isStatic = isStatic;
+	std::shared_ptr<KRigidbody> body;
+	CreateBodies(&desc, 1, &body);
+	return body->shape;
+}
+
+std::shared_ptr<KShape> KWorld::CreatePolygon(KPolygonGeometryPtr geometry, float x, float y, bool isStatic)
+{
+	KBodyDesc desc;
+	desc.type = KShape::ePoly;
+	desc.geometry = std::move(geometry);
+	desc.position = KVector2(x, y);
+	desc.isStatic = isStatic;
+	std::shared_ptr<KRigidbody> body;
+	CreateBodies(&desc, 1, &body);
+	return body->shape;
 }
 
 std::shared_ptr<KShape> KWorld::CreateBox(float width, float height, float x, float y, bool isStatic)
 {
-	std::shared_ptr<KPolygonShape> polygon;
-	polygon.reset(new KPolygonShape());
+	std::shared_ptr<KPolygonShape> polygon = std::allocate_shared<KPolygonShape>(KPoolAllocator<KPolygonShape>(&m_polygonPool));
 	{
-		polygon->SetBox(width, height);
+		std::shared_ptr<KPolygonGeometry> box = std::allocate_shared<KPolygonGeometry>(
+			KPoolAllocator<KPolygonGeometry>(&m_geometryPool));
+		box->BuildBox(width, height);
+		polygon->SetGeometry(box);
 		std::shared_ptr<KRigidbody> body = Add(polygon, x, y);
 		body->SetRotation(0);
 		body->BodyToShape();
@@ -265,3 +401,252 @@ std::shared_ptr<KShape> KWorld::CreateBox(float width, float height, float x, fl
 	}
 	return polygon;
 }
+
+void KWorld::CreateBodies(const KBodyDesc* descs, uint32 count, std::shared_ptr<KRigidbody>* bodies)
+{
+	// The pools are not thread safe, allocate up front. The bodies enter the
+	// store when the adds are flushed.
+	m_bodyStore.Reserve(m_bodyStore.GetCount() + count);
+	m_commands.reserve(m_commands.size() + count);
+	std::vector<KRigidbody*> created(count);
+	std::vector<std::shared_ptr<KPolygonGeometry>> geometries(count);	// built in parallel
+	for (uint32 i = 0; i < count; ++i)
+	{
+		const KBodyDesc& desc = descs[i];
+		std::shared_ptr<KShape> shape;
+		if (desc.type == KShape::eCircle)
+			shape = std::allocate_shared<KCircleShape>(KPoolAllocator<KCircleShape>(&m_circlePool), desc.radius);
+		else
+		{
+			shape = std::allocate_shared<KPolygonShape>(KPoolAllocator<KPolygonShape>(&m_polygonPool));
+			if (!desc.geometry)
+				geometries[i] = std::allocate_shared<KPolygonGeometry>(KPoolAllocator<KPolygonGeometry>(&m_geometryPool));
+		}
+
+		std::shared_ptr<KRigidbody> body = _NewRigidbody(shape, desc.position.x, desc.position.y);
+		body->m_pendingAdd = true;
+		m_commands.push_back(Command{ Command::eAdd, body });
+		created[i] = body.get();
+		if (bodies)
+			bodies[i] = body;
+	}
+
+	// Each task only writes its own shapes and bodies
+	m_threadPool.ParallelFor(count, 16, [&](uint32 begin, uint32 end)
+	{
+		for (uint32 i = begin; i < end; ++i)
+		{
+			const KBodyDesc& desc = descs[i];
+			KRigidbody& body = *created[i];
+			if (desc.type == KShape::ePoly)
+			{
+				KPolygonShape& polygon = static_cast<KPolygonShape&>(*body.shape);
+				if (desc.geometry)
+				{
+					polygon.SetGeometry(desc.geometry);
+				}
+				else
+				{
+					geometries[i]->Build(desc.vertices, desc.numVertices);
+					polygon.SetGeometry(std::move(geometries[i]));
+				}
+			}
+
+			body.shape->ComputeMass(1.0f);
+			if (desc.isStatic)
+				body.SetStatic();
+
+			body.SetVelocity(desc.velocity);
+			body.SetRotation(desc.rotation);
+			body.SetAngularVelocity(desc.angularVelocity);
+			body.SetMaterial(desc.material);
+			body.BodyToShape();
+			body.shape->ComputeAABB();
+		}
+	});
+}
+
+namespace
+{
+	struct Cut
+	{
+		bool					valid = false;
+		KVector2				entry;			// body space
+		KVector2				exit;
+		KPolygonGeometry		fragments[2];	// centroids in body space
+	};
+
+	// The first chord the blade cuts through the polygon: the blade has to
+	// enter from outside and leave again, a blade starting inside cuts nothing
+	// until it has left once. inside holds whether each blade point is inside.
+	void _FindCut(const KPolygonShape& polygon, const KVector2* blade, const bool* inside, uint32 count, Cut& cut)
+	{
+		bool entered = false;
+		for (uint32 i = 0; i + 1 < count && !cut.valid; ++i)
+		{
+			// A segment between two inside points stays inside
+			if (inside[i] && inside[i + 1])
+				continue;
+
+			const KVector2& a = blade[i];
+			const KVector2& b = blade[i + 1];
+			float t0, t1;
+			if (!KVectorUtil::LineSegmentConvexPolygonCrossing(a, b, polygon.m_vertices, polygon.m_vertexCount, t0, t1))
+				continue;
+			if (!entered)
+			{
+				if (t0 <= 0.0f)
+					continue;
+				entered = true;
+				cut.entry = a + t0 * (b - a);
+			}
+			if (t1 < 1.0f)
+			{
+				cut.exit = a + t1 * (b - a);
+				cut.valid = true;
+			}
+		}
+
+		// A blade grazing a corner cuts nothing
+		if (!cut.valid || KVector2::DistSquared(cut.entry, cut.exit) < EPSILON)
+		{
+			cut.valid = false;
+			return;
+		}
+
+		cut.valid = polygon.GetGeometry()->Split(cut.entry, cut.exit, cut.fragments[0], cut.fragments[1]);
+	}
+}
+
+uint32 KWorld::Slice(const KVector2* blade, uint32 count, std::vector<KSliceResult>* results)
+{
+	if (count < 2)
+		return 0;
+
+	// Broad phase, per blade segment
+	std::vector<KRigidbody*> candidates;
+	for (uint32 i = 0; i + 1 < count; ++i)
+	{
+		KAABB box;
+		box.min = KVector2::Min(blade[i], blade[i + 1]) - KVector2(k_sliceMargin, k_sliceMargin);
+		box.max = KVector2::Max(blade[i], blade[i + 1]) + KVector2(k_sliceMargin, k_sliceMargin);
+		m_spatialHash.Query(box, candidates);
+	}
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [](KRigidbody* body)
+	{
+		return body->IsStatic() || body->m_pendingRemoval || body->shape->GetType() != KShape::ePoly;
+	}), candidates.end());
+
+	// Narrow phase: each candidate is cut in its own body space
+	const uint32 numCandidates = (uint32)candidates.size();
+	std::vector<Cut> cuts(numCandidates);
+	m_threadPool.ParallelFor(numCandidates, 4, [&](uint32 begin, uint32 end)
+	{
+		std::vector<KVector2> localBlade(count);
+		std::unique_ptr<bool[]> inside(new bool[count]);
+		for (uint32 i = begin; i < end; ++i)
+		{
+			const KRigidbody& body = *candidates[i];
+			const KMatrix2 rotation(body.GetRotation());
+			const KMatrix2 inverse = rotation.Transpose();
+			for (uint32 k = 0; k < count; ++k)
+				localBlade[k] = inverse * (blade[k] - body.GetPosition());
+			const KPolygonShape& polygon = static_cast<const KPolygonShape&>(*body.shape);
+			KVectorUtil::IsPointInConvexPolygon(&localBlade[0], count, polygon.m_vertices, polygon.m_vertexCount,
+				inside.get());
+			_FindCut(polygon, &localBlade[0], inside.get(), count, cuts[i]);
+			if (cuts[i].valid)
+			{
+				cuts[i].fragments[0].Simplify(m_debrisPolicy.maxVertices);
+				cuts[i].fragments[1].Simplify(m_debrisPolicy.maxVertices);
+			}
+		}
+	});
+
+	// All fragments in one batch. A fragment keeps moving with the parent: its
+	// velocity is the parent's at the fragment's centroid.
+	std::vector<KBodyDesc> descs;
+	std::vector<KRigidbody*> descParents;
+	std::vector<uint32> cutBodies;
+	for (uint32 i = 0; i < numCandidates; ++i)
+	{
+		if (!cuts[i].valid)
+			continue;
+		const KRigidbody& body = *candidates[i];
+		const KMatrix2 rotation(body.GetRotation());
+		cutBodies.push_back(i);
+		for (const KPolygonGeometry& fragment : cuts[i].fragments)
+		{
+			const KVector2 offset = rotation * fragment.centroid;
+			KBodyDesc desc;
+			desc.type = KShape::ePoly;
+			desc.geometry = std::allocate_shared<KPolygonGeometry>(KPoolAllocator<KPolygonGeometry>(&m_geometryPool),
+				fragment);
+			desc.position = body.GetPosition() + offset;
+			desc.velocity = body.GetVelocity() + KVector2::Cross(body.GetAngularVelocity(), offset);
+			desc.rotation = body.GetRotation();
+			desc.angularVelocity = body.GetAngularVelocity();
+			desc.material = body.GetMaterial();
+
+			// Too small to simulate
+			if (fragment.area < m_debrisPolicy.minArea)
+			{
+				if (m_debrisPolicy.onRetire)
+					m_debrisPolicy.onRetire(KDebris{ desc.geometry, desc.position, desc.rotation, desc.velocity,
+						desc.angularVelocity, desc.material });
+				continue;
+			}
+			descs.push_back(desc);
+			descParents.push_back(candidates[i]);
+		}
+	}
+	const uint32 numCut = (uint32)cutBodies.size();
+	std::vector<std::shared_ptr<KRigidbody>> fragments(descs.size());
+	CreateBodies(descs.data(), (uint32)descs.size(), fragments.data());
+
+	if (results)
+		results->reserve(results->size() + numCut);
+	uint32 f = 0;
+	for (uint32 c = 0; c < numCut; ++c)
+	{
+		KRigidbody& body = *candidates[cutBodies[c]];
+		const Cut& cut = cuts[cutBodies[c]];
+		const KMatrix2 rotation(body.GetRotation());
+		KSliceResult result;
+		result.body = body.shared_from_this();
+		result.entry = body.GetPosition() + rotation * cut.entry;
+		result.exit = body.GetPosition() + rotation * cut.exit;
+		for (uint32 k = 0; f < descParents.size() && descParents[f] == &body; ++k, ++f)
+			result.fragments[k] = fragments[f];
+		if (results)
+			results->push_back(result);
+		Remove(body.shared_from_this());
+	}
+
+	// Fragments cut again or removed otherwise are gone, the rest are retired
+	// oldest first once over budget
+	m_fragments.erase(std::remove_if(m_fragments.begin(), m_fragments.end(), [this](const std::shared_ptr<KRigidbody>& body)
+	{
+		return !body->IsInWorld();
+	}), m_fragments.end());
+	m_fragments.insert(m_fragments.end(), fragments.begin(), fragments.end());
+	while (m_debrisPolicy.maxFragments != 0 && m_fragments.size() > m_debrisPolicy.maxFragments)
+	{
+		_RetireFragment(m_fragments.front());
+		m_fragments.pop_front();
+	}
+	return numCut;
+}
+
+void KWorld::_RetireFragment(std::shared_ptr<KRigidbody> body)
+{
+	if (m_debrisPolicy.onRetire)
+	{
+		const KPolygonShape& polygon = static_cast<const KPolygonShape&>(*body->shape);
+		m_debrisPolicy.onRetire(KDebris{ polygon.GetGeometry(), body->GetPosition(), body->GetRotation(),
+			body->GetVelocity(), body->GetAngularVelocity(), body->GetMaterial() });
+	}
+	Remove(body);
+}
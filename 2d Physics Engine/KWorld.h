@@ -5,12 +5,67 @@
 #ifndef _KWORLD_H_
 #define _KWORLD_H_
 
+#include <deque>
+#include <functional>
 #include "KMath.h"
 #include "KManifold.h"
+#include "KContactSolver.h"
+#include "KMaterial.h"
+#include "KBodyStore.h"
+#include "KPool.h"
+#include "KThreadPool.h"
 #include "KPhysicsEngine.h"
 
 #include "KSpatialHash.h"
 
+// Everything needed to create one body, see KWorld::CreateBodies()
+struct KBodyDesc
+{
+	KShape::Type	type = KShape::ePoly;
+	KPolygonGeometryPtr	geometry;			// ePoly: shared as is, else built from the vertices
+	const KVector2*	vertices = nullptr;	// ePoly: any points, their convex hull is used
+	uint32			numVertices = 0;
+	float			radius = 0.0f;		// eCircle
+	KVector2		position;
+	KVector2		velocity;
+	float			rotation = 0.0f;	// radians
+	float			angularVelocity = 0.0f;
+	KMaterialId		material = KMaterialTable::k_default;
+	bool			isStatic = false;
+};
+
+// One body cut by KWorld::Slice()
+struct KSliceResult
+{
+	std::shared_ptr<KRigidbody>	body;			// queued for removal, stays readable once removed
+	KVector2					entry;			// where the blade entered and left the body
+	KVector2					exit;
+	std::shared_ptr<KRigidbody>	fragments[2];	// queued like Add(), null if too small, see KDebrisPolicy
+};
+
+// A sliced fragment the debris policy retired, see KDebrisPolicy
+struct KDebris
+{
+	KPolygonGeometryPtr	geometry;
+	KVector2			position;
+	float				rotation = 0.0f;	// radians
+	KVector2			velocity;
+	float				angularVelocity = 0.0f;
+	KMaterialId			material = KMaterialTable::k_default;
+};
+
+// Keeps repeated slicing from growing the world without bound. Fragments
+// smaller than minArea never become bodies, and once more than maxFragments
+// fragments are alive the oldest ones are removed. Either way onRetire gets
+// the fragment, e.g. to replace it with particles.
+struct KDebrisPolicy
+{
+	float		minArea = 0.0f;
+	uint32		maxFragments = 0;	// 0: no limit
+	uint32		maxVertices = KPolygonGeometry::k_maxVertices;	// fragment hulls are simplified to this
+	std::function<void(const KDebris&)>	onRetire;
+};
+
 struct KWorld
 {
 public:
@@ -25,31 +80,86 @@ public:
 	static const bool		drawPenetration = false;
 
 public:
-	/*constructor*/			KWorld(float dt, uint32 iterations);
+	/*constructor*/			KWorld(float dt, uint32 minIterations, uint32 maxIterations);
+	// Bodies held past the world are detached, see KRigidbody
+	/*destructor*/			~KWorld();
 	void					GenerateCollisionInfo();
 	void					Step();
 	std::shared_ptr<KRigidbody>
 							CreateRigidbody(std::shared_ptr<KShape> shape, float x, float y);
 	std::shared_ptr<KRigidbody>
 							Add(std::shared_ptr<KShape> shape, float x, float y);
+	// Add() and Remove() are queued and take effect at the start of the next
+	// Step(), in call order. Remove() returns false if the body was already
+	// removed or is queued for removal.
 	bool					Remove(std::shared_ptr<KRigidbody> body);
 	void					Clear();
+	// Summed over the body, shape and geometry pools
+	KPoolStats				GetPoolStats() const;
 	// Factory members
 	std::shared_ptr<KShape> CreateCircle(float radius, float x, float y, bool isStatic = false);
-	std::shared_ptr<KShape> CreatePolygon(KVector2* vertices, uint32 numVertices, float x, float y, bool isStatic = false);
+	// Point clouds of k_parallelHullPoints or more are hulled in parallel
+	static const uint32		k_parallelHullPoints = 4096;
+	std::shared_ptr<KShape> CreatePolygon(const KVector2* vertices, uint32 numVertices, float x, float y, bool isStatic = false);
+	// O(1): the body shares the prototype's vertices and mass properties
+	std::shared_ptr<KShape> CreatePolygon(KPolygonGeometryPtr geometry, float x, float y, bool isStatic = false);
 	std::shared_ptr<KShape> CreateBox(float width, float height, float x, float y, bool isStatic = false);
+	// Creates count bodies at once, hulls and mass properties are computed in
+	// parallel. The bodies are queued like Add(), bodies may be null.
+	void					CreateBodies(const KBodyDesc* descs, uint32 count, std::shared_ptr<KRigidbody>* bodies = nullptr);
+	// Cuts every dynamic polygon the blade polyline passes through, along the
+	// chord between where the blade first enters and then leaves it. Candidates
+	// come from the spatial hash of the last Step(), so bodies added since are
+	// never cut. The cuts are found in parallel and all fragments created in
+	// one batch. Returns the number of bodies cut.
+	uint32					Slice(const KVector2* blade, uint32 count, std::vector<KSliceResult>* results = nullptr);
+	// Bodies move after the spatial hash is built, blade segments are grown by this
+	static const float		k_sliceMargin;
+	KDebrisPolicy			m_debrisPolicy;
 	KSpatialHash			m_spatialHash{ 3.0f }; // cell size
 
 private:
-	bool					_IsBodyInRemoveCandidate(std::shared_ptr<KRigidbody> body_);
-	void					_RemoveRigidbody();
+	void					_FlushCommands();
+	// Hands the fragment to the debris policy and removes it
+	void					_RetireFragment(std::shared_ptr<KRigidbody> body);
+	// CreateRigidbody() without computing the mass
+	std::shared_ptr<KRigidbody>
+							_NewRigidbody(std::shared_ptr<KShape> shape, float x, float y);
 
 public:
 	float m_dt;
-	uint32 m_iterations;
-	std::vector<std::shared_ptr<KRigidbody>>	m_bodies;
-	std::vector<std::shared_ptr<KRigidbody>>	m_removeCandidates;
+	uint32 m_minIterations;	// velocity iterations, see KContactSolver::Solve()
+	uint32 m_maxIterations;
+	// Soft step mode: with m_subSteps > 0 the step is split into sub-steps
+	// that each solve the soft contacts once, see KContactSolver::SoftStep()
+	uint32 m_subSteps = 0;
+	float m_contactHertz = 30.0f;			// contact stiffness
+	float m_contactDampingRatio = 10.0f;
+	// Bodies and shapes share a pool block with their shared_ptr control block.
+	// Declared before everything that may hold them.
+	KBlockPool				m_geometryPool;	// private geometry of created polygons
+	KBlockPool				m_bodyPool;
+	KBlockPool				m_circlePool;
+	KBlockPool				m_polygonPool;
+	KBodyStore				m_bodyStore;	// simulation state of m_bodies
+	std::vector<std::shared_ptr<KRigidbody>>	m_bodies;	// owns the bodies, which own their shapes
+	// Deferred Add() and Remove() calls
+	struct Command
+	{
+		enum Type
+		{
+			eAdd,
+			eRemove,
+		};
+		Type						type;
+		std::shared_ptr<KRigidbody>	body;
+	};
+	std::vector<Command>	m_commands;
+	std::deque<std::shared_ptr<KRigidbody>>	m_fragments;	// created by Slice(), oldest first
 	std::vector<KManifold>	m_contacts;
+	KMaterialTable			m_materials;
+	KThreadPool				m_threadPool;
+	KContactSolver			m_contactSolver;
 };
 
 #define _KWorld		KWorld::Singleton()